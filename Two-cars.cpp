@@ -9,13 +9,16 @@
 #include <cstdlib>
 #include <GL/freeglut.h>
 #include <time.h>
-
-// Constants for field and goal dimensions
-const float FIELD_RADIUS = 6.0f;  // Radius of the circular field
-const float GOAL_WIDTH = 1.5f;    // Width of the goal
-const float GOAL_HEIGHT = 1.0f;
-const float GOAL_DEPTH = 0.1f;    // Depth of the goal
-const float GOAL_OFFSET = 0.5f;   // Distance from the edge of the field to the goalposts
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "profiler.h"
+#include "scene.h"
+#include "input.h"
+#include "triple_buffer.h"
+#include "render_queue.h"
+#include "contact_solver.h"
+#include "tick_arena.h"
 
 // Window dimensions
 int width = 800, height = 600;
@@ -30,57 +33,70 @@ float pitch = 0.0f;
 float distance = 50.0f;
 float cameraX = 0.0f, cameraY = 10.0f, cameraZ = 50.0f;
 
-// Ball properties
-float ballRadius = 1.0f;
-float ballPosX = 0.0f, ballPosY = ballRadius, ballPosZ = 0.0f;
-float ballVelocityX = 0.0f, ballVelocityY = 0.0f, ballVelocityZ = 0.0f;
-float gravity = -0.098f;
-
-// Car dimensions
-const float CAR_LENGTH = 4.0f;
-const float CAR_WIDTH = 2.0f;
-const float CAR_HEIGHT = 1.5f;
+// Split-screen: one chase camera per car ('v' toggles)
+bool splitScreen = false;
+const float CHASE_DISTANCE = 8.0f;          // Behind the car, along its direction of travel
+const float CHASE_HEIGHT = 4.0f;
+const float CHASE_LOOK_AHEAD = 4.0f;
 
 // Camera position
 float cameraAngle = 0.0f;
 float cameraDistance = 15.0f;
 
-// Car movement properties
-struct Car {
-    float x;
-    float z;
-    float rotation;
-    float speed;
-    float acceleration;
-    bool isAccelerating;
-    bool isBraking;
-    bool isTurningLeft;
-    bool isTurningRight;
+// Simulation state, owned by the simulation thread once it is running.
+// The cars start with their corners inside the field wall.
+Car cars[2] = {
+    {3.5f, 0.0f, 0.0f, 0.0f, 0.0f, false, false, false, false, 0.0f, 0.0f, 0.0f},
+    {-3.5f, 0.0f, 180.0f, 0.0f, 0.0f, false, false, false, false, 0.0f, 0.0f, 0.0f}
 };
-
-Car redCar = {5.0f, 0.0f, 0.0f, 0.0f, 0.0f, false, false, false, false};
-Car blueCar = {-5.0f, 0.0f, 180.0f, 0.0f, 0.0f, false, false, false, false};
-
-const float MAX_SPEED = 0.3f;
-const float ACCELERATION = 0.01f;
-const float BRAKE_FORCE = 0.02f;
-const float TURN_SPEED = 3.0f;
-const float FRICTION = 0.005f;
-
-// Cloud structure
-struct Cloud {
-    float x, y, z;
-    float speedX, speedZ;
-    float size;
+Car& redCar = cars[0];
+Car& blueCar = cars[1];
+Football football = {0.0f, 0.0f, 0.0f, 0.0f};
+
+// Collisions between the cars, the ball and the wall
+ContactSolver contactSolver;
+WorkerPool contactPool(defaultWorkerCount());
+
+// Cloud layer, laid out once from a fixed seed
+const int CLOUD_COUNT = 5;
+const unsigned int SKY_SEED = 12345;
+Sky sky;
+
+// Fixed-step simulation fed by timestamped input
+const long long TICK_NS = 16666667;         // 60 Hz
+const int MAX_TICKS_PER_UPDATE = 5;         // Drop the backlog after a long stall instead of spiralling
+const int UPDATE_POLL_MS = 4;               // How often the GLUT thread checks for a new snapshot
+InputQueue<256> inputQueue;
+long long tickCount = 0;
+long long pendingInputNs = 0;               // Earliest input not yet known to be on screen
+TickArena tickArena;                        // Transient per-tick data, reset after every tick
+
+// Everything display() needs from one simulation tick
+struct WorldState {
+    Car redCar, blueCar;
+    Football football;
+    Sky sky;                    // Laid out once per slot; publishWorld() only copies cloud positions
+    long long tick;
+    long long inputNs;          // Earliest input not yet acknowledged by the renderer, or 0
 };
 
-Cloud clouds[5];
+// The simulation thread publishes a snapshot after each update and the renderer draws the latest one
+TripleBuffer<WorldState> world;
+std::thread simulationThread;
+std::atomic<bool> simulationRunning{false};
+std::atomic<long long> presentedInputNs{0};     // Written by the renderer after drawing an input
+
+// Draws of the current frame, sorted before they are submitted
+RenderQueue renderQueue;
 
 void setupCamera() {
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     gluPerspective(45.0, (GLfloat)width / (GLfloat)height, 1.0, 800.0);
 
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
     cameraX = distance * cosf(pitch) * sinf(yaw);
     cameraY = distance * sinf(pitch);
     cameraZ = distance * cosf(pitch) * cosf(yaw);
@@ -90,6 +106,35 @@ void setupCamera() {
               0.0f, 1.0f, 0.0f);
 }
 
+// Chase camera for one split-screen view, looking past the car along its direction of travel
+void setupChaseCamera(const Car& car, float aspect) {
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluPerspective(60.0, aspect, 0.5, 800.0);
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    float r = car.rotation * (float)M_PI / 180.0f;
+    float headingX = sinf(r), headingZ = cosf(r);
+    gluLookAt(car.x - headingX * CHASE_DISTANCE, CHASE_HEIGHT, car.z - headingZ * CHASE_DISTANCE,
+              car.x + headingX * CHASE_LOOK_AHEAD, 0.0f, car.z + headingZ * CHASE_LOOK_AHEAD,
+              0.0f, 1.0f, 0.0f);
+}
+
+// Sets the viewport and camera of one view: the orbit camera alone, or a chase camera per car
+void setupView(const WorldState& state, int view, int viewCount) {
+    int x, y, w, h;
+    renderSplitViewport(view, viewCount, width, height, x, y, w, h);
+    glViewport(x, y, w, h);
+
+    if (viewCount == 1) {
+        setupCamera();
+    } else {
+        setupChaseCamera(view == 0 ? state.redCar : state.blueCar, (float)w / (float)h);
+    }
+}
+
 void mouseMotion(int x, int y) {
     if (isMousePressed) {
         int deltaX = x - lastX;
@@ -103,7 +148,6 @@ void mouseMotion(int x, int y) {
     }
     lastX = x;
     lastY = y;
-    glutPostRedisplay();
 }
 
 void mouseButton(int button, int state, int x, int y) {
@@ -122,387 +166,233 @@ void mouseWheel(int button, int dir, int x, int y) {
         distance += 2.0f;
         if (distance > 100.0f) distance = 100.0f;
     }
-    glutPostRedisplay();
-}
-
-void drawCylinder(float radius, float height, int slices, int stacks) {
-    GLUquadric* quad = gluNewQuadric();
-    gluCylinder(quad, radius, radius, height, slices, stacks);
-    gluDeleteQuadric(quad);
-}
-
-void drawHollowPipe(float outerRadius, float height) {
-    glPushMatrix();
-    glColor3f(1.0f, 1.0f, 1.0f);
-    drawCylinder(outerRadius, height, 10, 10);
-    glPopMatrix();
 }
 
-void drawField() {
-    glColor3f(0.0, 0.8, 0.0);
-
-    glBegin(GL_POLYGON);
-    for (int i = 0; i < 360; i++) {
-        float angle = i * 3.14159f / 180.0f;
-        glVertex3f(FIELD_RADIUS * cos(angle), 0.0f, FIELD_RADIUS * sin(angle));
-    }
-    glEnd();
-
-    glPushMatrix();
-    glLineWidth(10.0);
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glRotatef(-90.0f, 0.0f, 1.0f, 0.0f);
-    glBegin(GL_LINES);
-    glVertex3f(0.0f, 0.0f, -5.9f);
-    glVertex3f(0.0f, 0.0f, 5.9f);
-    glEnd();
-    glPopMatrix();
-
-    glBegin(GL_LINE_STRIP);
-    glLineWidth(10.0);
-    float centerCircleRadius = 1.0f;
-    for (int i = 0; i < 360; i++) {
-        float angle = i * 3.14159f / 180.0f;
-        glVertex3f(centerCircleRadius * cos(angle), 0.0f, centerCircleRadius * sin(angle));
+// Keyboard function to handle regular key presses.
+// Car controls are queued for the simulation; the profiler keys act straight away.
+void keyboard(unsigned char key, int x, int y) {
+    switch(key) {
+        case 'v': case 'V': splitScreen = !splitScreen; glutPostRedisplay(); break;
+
+#ifdef ENABLE_PROFILER
+        // Profiler overlay and trace capture; nothing is recorded in builds without the profiler
+        case 'p': case 'P': profiler().overlayVisible = !profiler().overlayVisible; break;
+        case 't': case 'T':
+            if (profiler().capturing) {
+                if (profilerStopTrace("trace.json")) std::cout << "Wrote trace.json" << std::endl;
+            } else {
+                profilerStartTrace();
+            }
+            break;
+#endif
+
+        default: inputQueue.push(InputEventType::KEY_DOWN, key); break;
     }
-    glEnd();
 }
 
-void drawLeftGoal(float x, float z) {
-    glPushMatrix();
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glTranslatef(x, 3.0f, z);
-
-    glPushMatrix();
-    glRotatef(90.0f, 5.0f, 0.0f, 0.0f);
-
-    glPushMatrix();
-    glTranslatef(16.5f, 18.0f, 1.5f);
-    drawHollowPipe(0.1f, 1.5f);
-    glPopMatrix();
-
-    glPushMatrix();
-    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
-
-    glPushMatrix();
-    glTranslatef(13.5f, 18.0f, 1.5f);
-    drawHollowPipe(0.1f, 1.5f);
-    glPopMatrix();
-
-    glPushMatrix();
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-
-    glPushMatrix();
-    glTranslatef(-18.0f, -1.5f, 13.5f);
-    drawHollowPipe(0.1f, 3.0f);
-    glPopMatrix();
+// Keyboard function to handle key releases
+void keyboardUp(unsigned char key, int x, int y) {
+    inputQueue.push(InputEventType::KEY_UP, key);
 }
 
-void drawRightGoal(float x, float z) {
-    glPushMatrix();
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glTranslatef(x, 3.0f, z);
-
-    glPushMatrix();
-    glRotatef(90.0f, 5.0f, 0.0f, 0.0f);
-
-    glPushMatrix();
-    glTranslatef(16.5f, 18.0f, 1.5f);
-    drawHollowPipe(0.1f, 1.5f);
-    glPopMatrix();
-
-    glPushMatrix();
-    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
-
-    glPushMatrix();
-    glTranslatef(13.5f, 18.0f, 1.5f);
-    drawHollowPipe(0.1f, 1.5f);
-    glPopMatrix();
-
-    glPushMatrix();
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-
-    glPushMatrix();
-    glTranslatef(-18.0f, -1.5f, 13.5f);
-    drawHollowPipe(0.1f, 3.0f);
-    glPopMatrix();
+// Special keyboard function for arrow keys
+void specialKeys(int key, int x, int y) {
+    inputQueue.push(InputEventType::SPECIAL_DOWN, key);
 }
 
-void drawWheel(float x, float y, float z) {
-    glPushMatrix();
-    glTranslatef(x, y, z);
-    glRotatef(90, 0, 1, 0);
-    glColor3f(0.1f, 0.1f, 0.1f);
-    glutSolidTorus(0.2f, 0.4f, 20, 20);
-    glPopMatrix();
+// Special keyboard function for arrow key releases
+void specialKeysUp(int key, int x, int y) {
+    inputQueue.push(InputEventType::SPECIAL_UP, key);
 }
 
-void drawCar(Car& car, bool isRed) {
-    glPushMatrix();
-    glTranslatef(car.x, 0.0f, car.z);
-    glRotatef(car.rotation, 0.0f, 1.0f, 0.0f);
-
-    // Main body
-    glPushMatrix();
-    if (isRed) {
-        glColor3f(1.0f, 0.0f, 0.0f);
-    } else {
-        glColor3f(0.0f, 0.0f, 1.0f);
-    }
-    glScalef(4.0f, 1.5f, 2.0f);
-    glutSolidCube(1.0f);
-    glPopMatrix();
-
-    // Roof
-    glPushMatrix();
-    glTranslatef(0.0f, 0.75f, 0.0f);
-    if (isRed) {
-        glColor3f(0.8f, 0.0f, 0.0f);
+// Applies one queued input event to the car controls
+void applyInput(const InputEvent& event) {
+    bool pressed = event.type == InputEventType::KEY_DOWN || event.type == InputEventType::SPECIAL_DOWN;
+
+    if (event.type == InputEventType::KEY_DOWN || event.type == InputEventType::KEY_UP) {
+        switch(event.key) {
+            // Red car controls (WASD)
+            case 'w': case 'W': redCar.isAccelerating = pressed; break;
+            case 's': case 'S': redCar.isBraking = pressed; break;
+            case 'a': case 'A': redCar.isTurningLeft = pressed; break;
+            case 'd': case 'D': redCar.isTurningRight = pressed; break;
+        }
     } else {
-        glColor3f(0.0f, 0.0f, 0.8f);
+        switch(event.key) {
+            // Blue car controls (arrow keys)
+            case GLUT_KEY_UP: blueCar.isAccelerating = pressed; break;
+            case GLUT_KEY_DOWN: blueCar.isBraking = pressed; break;
+            case GLUT_KEY_LEFT: blueCar.isTurningLeft = pressed; break;
+            case GLUT_KEY_RIGHT: blueCar.isTurningRight = pressed; break;
+        }
     }
-    glScalef(2.4f, 0.75f, 2.0f);
-    glutSolidCube(1.0f);
-    glPopMatrix();
-
-    // Windows
-    glPushMatrix();
-    glColor3f(0.1f, 0.1f, 0.1f);
-    glTranslatef(0.0f, 0.45f, 0.0f);
-    glScalef(2.0f, 0.45f, 2.1f);
-    glutSolidCube(1.0f);
-    glPopMatrix();
-
-    // Wheels
-    drawWheel(1.4f, -0.75f, 1.1f);
-    drawWheel(1.4f, -0.75f, -1.1f);
-    drawWheel(-1.4f, -0.75f, 1.1f);
-    drawWheel(-1.4f, -0.75f, -1.1f);
-
-    // Headlights
-    glPushMatrix();
-    glColor3f(1.0f, 1.0f, 0.0f);
-    glTranslatef(1.8f, 0.0f, 0.6f);
-    glutSolidSphere(0.2f, 10, 10);
-    glTranslatef(0.0f, 0.0f, -1.2f);
-    glutSolidSphere(0.2f, 10, 10);
-    glPopMatrix();
-
-    glPopMatrix();
 }
 
-void drawFootball(float x, float y, float z) {
-    glPushMatrix();
-    glTranslatef(-x, y, z);
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glutSolidSphere(0.25f, 20, 10);
-    glPopMatrix();
-}
-
-void drawCloud(Cloud& cloud) {
-    glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+// Runs one simulation step covering the TICK_NS up to tickEndNs
+void simulateTick(long long tickEndNs) {
+    TickScope tick(tickArena);
 
-    for (int i = 0; i < 3; i++) {
-        float offsetX = (rand() % 200 - 100) / 100.0f;
-        float offsetY = (rand() % 200 - 100) / 100.0f;
-        float offsetZ = (rand() % 200 - 100) / 100.0f;
-        float cloudSize = cloud.size * ((rand() % 50 + 50) / 100.0f);
-
-        glPushMatrix();
-        glTranslatef(cloud.x + offsetX, cloud.y + offsetY, cloud.z + offsetZ);
-        glutSolidSphere(cloudSize, 10, 10);
-        glPopMatrix();
+    // Forget the pending input once a frame showing it has been presented
+    if (pendingInputNs != 0 && presentedInputNs.load(std::memory_order_acquire) == pendingInputNs) {
+        pendingInputNs = 0;
     }
-}
 
-void drawCube(float x, float y, float z, float width, float height, float depth) {
-    glPushMatrix();
-    glTranslatef(x, y, z);
-    glScalef(width, height, depth);
-
-    glBegin(GL_QUADS);
-
-    // Front face
-    glColor3f(0.0, 0.0, 0.0);
-    glVertex3f(-0.5, -0.5, 0.5);
-    glVertex3f(0.5, -0.5, 0.5);
-    glVertex3f(0.5, 0.5, 0.5);
-    glVertex3f(-0.5, 0.5, 0.5);
-
-    // Back face
-    glColor3f(0.0, 0.0, 0.0);
-    glVertex3f(-0.5, -0.5, -0.5);
-    glVertex3f(-0.5, 0.5, -0.5);
-    glVertex3f(0.5, 0.5, -0.5);
-    glVertex3f(0.5, -0.5, -0.5);
-
-    // Other faces...
-    glEnd();
-    glPopMatrix();
-}
-
-void updateCarPhysics(Car& car) {
-    // Update acceleration
-    if (car.isAccelerating) {
-        car.acceleration = ACCELERATION;
-    } else if (car.isBraking) {
-        car.acceleration = -BRAKE_FORCE;
-    } else {
-        car.acceleration = 0.0f;
+    // Only inputs that happened before the end of this tick
+    InputEvent event;
+    while (inputQueue.popUntil(tickEndNs, event)) {
+        applyInput(event);
+        if (pendingInputNs == 0) pendingInputNs = event.timestampNs;
     }
 
-    // Apply acceleration to speed
-    car.speed += car.acceleration;
-
-    // Apply friction
-    if (car.speed > 0) {
-        car.speed -= FRICTION;
-    } else if (car.speed < 0) {
-        car.speed += FRICTION;
+    {
+        PROFILE_SCOPE("car physics");
+        updateCarControls(redCar);
+        updateCarControls(blueCar);
+        stepContacts(contactSolver, cars, 2, &football, &contactPool);
     }
 
-    // If speed is very close to 0, set it to 0
-    if (fabs(car.speed) < FRICTION) {
-        car.speed = 0.0f;
-    }
+    // Update clouds
+    PROFILE_SCOPE("cloud update");
+    updateSky(sky);
 
-    // Clamp speed
-    if (car.speed > MAX_SPEED) car.speed = MAX_SPEED;
-    if (car.speed < -MAX_SPEED/2) car.speed = -MAX_SPEED/2;
+    tickCount++;
+}
 
-    // Update rotation
-    if (car.speed != 0) {
-        if (car.isTurningLeft) car.rotation += TURN_SPEED * (car.speed/MAX_SPEED);
-        if (car.isTurningRight) car.rotation -= TURN_SPEED * (car.speed/MAX_SPEED);
-    }
+// Copies the simulation state into the free snapshot slot and hands it to the renderer
+void publishWorld() {
+    WorldState& state = world.writeBuffer();
+    state.redCar = redCar;
+    state.blueCar = blueCar;
+    state.football = football;
+    std::copy(sky.x.begin(), sky.x.end(), state.sky.x.begin());
+    std::copy(sky.z.begin(), sky.z.end(), state.sky.z.begin());
+    state.tick = tickCount;
+    state.inputNs = pendingInputNs;
+    world.publish();
+}
 
-    // Convert rotation to radians for movement calculation
-    float rotationRad = car.rotation * M_PI / 180.0f;
-
-    // Update position based on speed and rotation
-    car.x += car.speed * sin(rotationRad);
-    car.z += car.speed * cos(rotationRad);
-
-    // Keep cars within field bounds
-    float maxDist = FIELD_RADIUS - 2.0f; // Buffer for car size
-    float dist = sqrt(car.x * car.x + car.z * car.z);
-    if (dist > maxDist) {
-        float angle = atan2(car.x, car.z);
-        car.x = maxDist * sin(angle);
-        car.z = maxDist * cos(angle);
-        car.speed *= 0.5f; // Reduce speed on collision
+// Simulation thread: runs the ticks that are due, publishes, then sleeps until the next one
+void simulationLoop() {
+    long long simulationTimeNs = inputClockNs();     // End of the last simulated tick
+
+    while (simulationRunning.load(std::memory_order_relaxed)) {
+        int ticks = 0;
+        {
+            PROFILE_SCOPE("update");
+            long long now = inputClockNs();
+            while (simulationTimeNs + TICK_NS <= now && ticks < MAX_TICKS_PER_UPDATE) {
+                simulationTimeNs += TICK_NS;
+                simulateTick(simulationTimeNs);
+                ticks++;
+            }
+            if (ticks == MAX_TICKS_PER_UPDATE) simulationTimeNs = now;
+        }
+        if (ticks > 0) publishWorld();
+
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+            std::chrono::nanoseconds(simulationTimeNs + TICK_NS)));
     }
 }
 
-// Keyboard function to handle regular key presses
-void keyboard(unsigned char key, int x, int y) {
-    switch(key) {
-        // Red car controls (WASD)
-        case 'w': case 'W': redCar.isAccelerating = true; break;
-        case 's': case 'S': redCar.isBraking = true; break;
-        case 'a': case 'A': redCar.isTurningLeft = true; break;
-        case 'd': case 'D': redCar.isTurningRight = true; break;
-    }
-    glutPostRedisplay();
+// Only redraw when the simulation has published a new snapshot
+void update(int value) {
+    if (world.hasUpdate()) glutPostRedisplay();
+    glutTimerFunc(UPDATE_POLL_MS, update, 0);
 }
 
-// Keyboard function to handle key releases
-void keyboardUp(unsigned char key, int x, int y) {
-    switch(key) {
-        case 'w': case 'W': redCar.isAccelerating = false; break;
-        case 's': case 'S': redCar.isBraking = false; break;
-        case 'a': case 'A': redCar.isTurningLeft = false; break;
-        case 'd': case 'D': redCar.isTurningRight = false; break;
-    }
-    glutPostRedisplay();
+// Render queue callbacks
+void drawFieldItem(void*) {
+    PROFILE_SCOPE("stadium");
+    drawField();
 }
 
-// Special keyboard function for arrow keys
-void specialKeys(int key, int x, int y) {
-    switch(key) {
-        case GLUT_KEY_UP: blueCar.isAccelerating = true; break;
-        case GLUT_KEY_DOWN: blueCar.isBraking = true; break;
-        case GLUT_KEY_LEFT: blueCar.isTurningLeft = true; break;
-        case GLUT_KEY_RIGHT: blueCar.isTurningRight = true; break;
-    }
-    glutPostRedisplay();
+void drawLeftGoalItem(void*) {
+    PROFILE_SCOPE("stadium");
+    drawLeftGoal(-15.0f, -12.5f);
 }
 
-// Special keyboard function for arrow key releases
-void specialKeysUp(int key, int x, int y) {
-    switch(key) {
-        case GLUT_KEY_UP: blueCar.isAccelerating = false; break;
-        case GLUT_KEY_DOWN: blueCar.isBraking = false; break;
-        case GLUT_KEY_LEFT: blueCar.isTurningLeft = false; break;
-        case GLUT_KEY_RIGHT: blueCar.isTurningRight = false; break;
-    }
-    glutPostRedisplay();
+void drawRightGoalItem(void*) {
+    PROFILE_SCOPE("stadium");
+    drawRightGoal(-15.0f, -23.5f);
 }
 
-void update(int value) {
-    updateCarPhysics(redCar);
-    updateCarPhysics(blueCar);
+void drawSeatsItem(void*) {
+    PROFILE_SCOPE("stadium");
+    drawSeats(6);
+}
 
-    // Update clouds
-    for (int i = 0; i < 5; i++) {
-        clouds[i].x += clouds[i].speedX;
-        clouds[i].z += clouds[i].speedZ;
-
-        // Reset cloud position if it moves off screen
-        if (clouds[i].x > 10.0f) clouds[i].x = -10.0f;
-        if (clouds[i].x < -10.0f) clouds[i].x = 10.0f;
-        if (clouds[i].z > 10.0f) clouds[i].z = -10.0f;
-        if (clouds[i].z < -10.0f) clouds[i].z = 10.0f;
-    }
+void drawFootballItem(void* data) {
+    Football& ball = *(Football*)data;
+    drawFootball(ball.x, 0.3f, ball.z);
+}
+
+// The car batch is built once per frame in display() and replayed in every view
+void drawCarsItem(void*) {
+    PROFILE_SCOPE("cars");
+    batchDraw(sceneBatch());
+}
 
-    glutPostRedisplay();
-    glutTimerFunc(16, update, 0); // 60 FPS update rate
+void drawSkyItem(void* data) {
+    PROFILE_SCOPE("clouds");
+    drawSky(*(Sky*)data);
 }
 
 void display() {
+    profilerNewFrame();
+    PROFILE_SCOPE("display");
+
+    // Latest snapshot; the simulation keeps running on the other two slots meanwhile
+    WorldState& state = world.latest();
+
     glClearColor(135.0f/255.0f, 206.0f/255.0f, 235.0f/255.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    setupCamera();
+    // Transform the car parts once for all views
+    {
+        PROFILE_SCOPE("cars");
+        batchCar(sceneBatch(), state.redCar, true);
+        batchCar(sceneBatch(), state.blueCar, false);
+    }
 
-    // Draw the scene
-    drawField();
-    drawLeftGoal(-15.0f, -12.5f);
-    drawRightGoal(-15.0f, -23.5f);
+    int viewCount = splitScreen ? 2 : 1;
+    renderQueueBeginViews(renderQueue);
+    for (int view = 0; view < viewCount; view++) {
+        setupView(state, view, viewCount);
+        renderQueueAddView(renderQueue);
+    }
 
-    // Draw seats
-    drawCube(-10.0f, 0.25f, 0.0f, 1.0f, 0.5f, 15.0f);
-    drawCube(-11.0f, 0.5f, 0.0f, 1.0f, 1.0f, 15.0f);
-    drawCube(-12.0f, 0.75f, 0.0f, 1.0f, 1.5f, 15.0f);
-    drawCube(-13.0f, 1.0f, 0.0f, 1.0f, 2.0f, 15.0f);
-    drawCube(-14.0f, 1.25f, 0.0f, 1.0f, 2.5f, 15.0f);
-    drawCube(-15.0f, 1.5f, 0.0f, 1.0f, 3.0f, 15.0f);
-
-    drawFootball(0.0, 0.3, 0.0);
-
-    // Draw cars
-    drawCar(redCar, true);
-    drawCar(blueCar, false);
-
-    // Draw clouds with transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    for (int i = 0; i < 5; i++) {
-        drawCloud(clouds[i]);
+    // Queue the scene once for every view. The stadium is drawn in every view; the ball and the
+    // cars, one batched item in a sphere around both of them, only where they can be seen.
+    float carsX = (state.redCar.x + state.blueCar.x) * 0.5f, carsZ = (state.redCar.z + state.blueCar.z) * 0.5f;
+    float carsRadius = sqrtf((state.redCar.x - carsX) * (state.redCar.x - carsX) +
+                             (state.redCar.z - carsZ) * (state.redCar.z - carsZ)) + CAR_LENGTH;
+    renderQueueAdd(renderQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_FIELD, 0.0f, 0.0f, 0.0f, drawFieldItem, NULL);
+    renderQueueAdd(renderQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_GOAL, -15.0f, 3.0f, -12.5f, drawLeftGoalItem, NULL);
+    renderQueueAdd(renderQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_GOAL, -15.0f, 3.0f, -23.5f, drawRightGoalItem, NULL);
+    renderQueueAdd(renderQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_SEATS, -13.0f, 1.0f, 0.0f, drawSeatsItem, NULL);
+    renderQueueAddBounded(renderQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_BALL, state.football.x, 0.3f, state.football.z,
+                          BALL_RADIUS, drawFootballItem, &state.football);
+    renderQueueAddBounded(renderQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_CARS, carsX, 0.0f, carsZ, carsRadius,
+                          drawCarsItem, NULL);
+
+    // Clouds blend over everything else; drawSky() sorts the puffs again for each camera
+    renderQueueAdd(renderQueue, PASS_TRANSLUCENT, MATERIAL_SPRITE, SCENE_SKY, 0.0f, 7.5f, 0.0f, drawSkyItem, &state.sky);
+
+    for (int view = 0; view < viewCount; view++) {
+        PROFILE_SCOPE("view");
+        setupView(state, view, viewCount);
+        renderQueueFlushView(renderQueue, view);
     }
-    glDisable(GL_BLEND);
+    batchClear(sceneBatch());
 
+    glViewport(0, 0, width, height);
+    profilerDrawOverlay(width, height);
     glutSwapBuffers();
-}
 
-void initClouds() {
-    for (int i = 0; i < 5; i++) {
-        clouds[i].x = rand() % 20 - 10;
-        clouds[i].y = 5 + rand() % 5;
-        clouds[i].z = rand() % 20 - 10;
-        clouds[i].speedX = (rand() % 3 + 1) * 0.002f;
-        clouds[i].speedZ = (rand() % 3 + 1) * 0.002f;
-        clouds[i].size = rand() % 3 + 2;
+    // Time from the first input this frame reflects until it was handed to the display
+    if (state.inputNs != 0 && state.inputNs != presentedInputNs.load(std::memory_order_relaxed)) {
+        PROFILE_LATENCY(state.inputNs, inputClockNs());
+        presentedInputNs.store(state.inputNs, std::memory_order_release);
     }
 }
 
@@ -520,6 +410,8 @@ void reshape(int w, int h) {
     setupProjection(w, h);
 }
 
+TICK_ALLOCATION_TRACKING
+
 int main(int argc, char** argv) {
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
@@ -528,8 +420,17 @@ int main(int argc, char** argv) {
 
     glEnable(GL_DEPTH_TEST);
 
-    // Initialize clouds
-    initClouds();
+    // Initialize clouds, and every snapshot slot with the same layout
+    initSky(sky, CLOUD_COUNT, SKY_SEED);
+    for (int i = 0; i < 3; i++) {
+        WorldState& state = world.slot(i);
+        state.redCar = redCar;
+        state.blueCar = blueCar;
+        state.football = football;
+        initSky(state.sky, CLOUD_COUNT, SKY_SEED);
+        state.tick = 0;
+        state.inputNs = 0;
+    }
 
     // Register callbacks
     glutDisplayFunc(display);
@@ -542,9 +443,20 @@ int main(int argc, char** argv) {
     glutSpecialFunc(specialKeys);
     glutSpecialUpFunc(specialKeysUp);
 
-    // Start the update timer
+    // Start the simulation thread and the redisplay timer
+    simulationRunning = true;
+    simulationThread = std::thread(simulationLoop);
     glutTimerFunc(0, update, 0);
 
+    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
     glutMainLoop();
+
+    simulationRunning = false;
+    simulationThread.join();
+
+#ifdef TRACK_TICK_ALLOCATIONS
+    std::cout << "Tick heap allocations: " << tickHeapAllocations().load() << " over " << tickCount
+              << " ticks, arena high water " << tickArena.highWaterBytes() << " bytes" << std::endl;
+#endif
     return 0;
 }
@@ -0,0 +1,267 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Batched drawing for the small moving meshes: car parts, headlights and power-ups.
+//
+// Each batchAdd() transforms one copy of a mesh on the CPU, stores the per-vertex color and
+// normal with it, and appends it to that mesh's vertex array. batchDraw() then draws every
+// queued copy of a mesh with a single glDrawArrays, and can run again for each split-screen view
+// until batchClear() empties the batch; batchFlush() does both. The draw call count no longer
+// grows with the number of objects. The arrays keep their capacity from frame to frame, so after the first
+// few frames a batch never allocates.
+//
+// Only GL 1.1 client arrays are used, which is all opengl32 offers without an extension loader.
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <math.h>
+#include <vector>
+#include <GL/gl.h>
+#include "profiler.h"
+
+enum BatchMesh {
+    MESH_CUBE,          // Unit cube centred on the origin
+    MESH_TORUS,         // Around the Z axis, outer radius 1, tube radius 0.5
+    MESH_THIN_TORUS,    // Around the Z axis, outer radius 1, tube radius 1/3, 10 x 10 (Rocket League wheels)
+    MESH_SPHERE,        // Radius 1, 10 slices x 10 stacks
+    MESH_OCTAHEDRON,    // Radius 1, same as glutSolidOctahedron
+    MESH_COUNT
+};
+
+// Column-major affine transform, built up the same way as the GL matrix stack
+struct BatchTransform {
+    float m[16];
+};
+
+inline BatchTransform batchIdentity() {
+    BatchTransform t = {{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+    return t;
+}
+
+// Same as glTranslatef
+inline void batchTranslate(BatchTransform& t, float x, float y, float z) {
+    for (int row = 0; row < 3; row++) {
+        t.m[12 + row] += t.m[row] * x + t.m[4 + row] * y + t.m[8 + row] * z;
+    }
+}
+
+// Same as glRotatef: angle in degrees around the (normalised) axis
+inline void batchRotate(BatchTransform& t, float angle, float x, float y, float z) {
+    float length = sqrtf(x * x + y * y + z * z);
+    if (length == 0.0f) return;
+    x /= length;
+    y /= length;
+    z /= length;
+
+    float radians = angle * 3.14159265f / 180.0f;
+    float c = cosf(radians), s = sinf(radians), k = 1.0f - c;
+    float r[3][3] = {   // r[column][row]
+        {x * x * k + c, y * x * k + z * s, x * z * k - y * s},
+        {x * y * k - z * s, y * y * k + c, y * z * k + x * s},
+        {x * z * k + y * s, y * z * k - x * s, z * z * k + c}
+    };
+
+    float result[12];
+    for (int col = 0; col < 3; col++) {
+        for (int row = 0; row < 3; row++) {
+            result[col * 4 + row] = t.m[row] * r[col][0] + t.m[4 + row] * r[col][1] + t.m[8 + row] * r[col][2];
+        }
+    }
+    for (int col = 0; col < 3; col++) {
+        for (int row = 0; row < 3; row++) t.m[col * 4 + row] = result[col * 4 + row];
+    }
+}
+
+// Same as glScalef
+inline void batchScale(BatchTransform& t, float x, float y, float z) {
+    for (int row = 0; row < 3; row++) {
+        t.m[row] *= x;
+        t.m[4 + row] *= y;
+        t.m[8 + row] *= z;
+    }
+}
+
+// Untransformed mesh: normal (3) then position (3) per vertex
+struct BatchMeshData {
+    GLenum mode;
+    std::vector<float> vertices;
+    int vertexCount() const { return (int)vertices.size() / 6; }
+};
+
+inline void meshVertex(BatchMeshData& mesh, float nx, float ny, float nz, float x, float y, float z) {
+    float v[6] = {nx, ny, nz, x, y, z};
+    mesh.vertices.insert(mesh.vertices.end(), v, v + 6);
+}
+
+// Torus with outer radius 1, same layout as solidTorus()
+inline void meshTorus(BatchMeshData& torus, float tube, int sides, int rings) {
+    const float twoPi = 6.2831853f;
+    torus.mode = GL_QUADS;
+    for (int i = 0; i < rings; i++) {
+        for (int j = 0; j < sides; j++) {
+            for (int k = 0; k < 4; k++) {
+                float u = (i + (k == 1 || k == 2)) * twoPi / rings;
+                float v = (j + (k >= 2)) * twoPi / sides;
+                float nx = cosf(u) * cosf(v), ny = sinf(u) * cosf(v), nz = sinf(v);
+                meshVertex(torus, nx, ny, nz, cosf(u) + nx * tube, sinf(u) + ny * tube, nz * tube);
+            }
+        }
+    }
+}
+
+// Builds the mesh templates once
+inline const BatchMeshData& batchMeshData(BatchMesh mesh) {
+    static BatchMeshData meshes[MESH_COUNT];
+    static bool built = false;
+    if (!built) {
+        const float twoPi = 6.2831853f;
+
+        // Cube, same faces as solidCube()
+        static const float normals[6][3] = {
+            {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+        };
+        static const float corners[6][4][3] = {
+            {{1, -1, -1}, {1, 1, -1}, {1, 1, 1}, {1, -1, 1}},
+            {{-1, -1, 1}, {-1, 1, 1}, {-1, 1, -1}, {-1, -1, -1}},
+            {{-1, 1, -1}, {-1, 1, 1}, {1, 1, 1}, {1, 1, -1}},
+            {{-1, -1, -1}, {1, -1, -1}, {1, -1, 1}, {-1, -1, 1}},
+            {{-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}},
+            {{-1, -1, -1}, {-1, 1, -1}, {1, 1, -1}, {1, -1, -1}}
+        };
+        BatchMeshData& cube = meshes[MESH_CUBE];
+        cube.mode = GL_QUADS;
+        for (int face = 0; face < 6; face++) {
+            for (int i = 0; i < 4; i++) {
+                meshVertex(cube, normals[face][0], normals[face][1], normals[face][2],
+                           corners[face][i][0] * 0.5f, corners[face][i][1] * 0.5f, corners[face][i][2] * 0.5f);
+            }
+        }
+
+        meshTorus(meshes[MESH_TORUS], 0.5f, 20, 20);
+        meshTorus(meshes[MESH_THIN_TORUS], 1.0f / 3.0f, 10, 10);
+
+        // Sphere as latitude/longitude quads
+        const int slices = 10, stacks = 10;
+        BatchMeshData& sphere = meshes[MESH_SPHERE];
+        sphere.mode = GL_QUADS;
+        for (int i = 0; i < stacks; i++) {
+            for (int j = 0; j < slices; j++) {
+                for (int k = 0; k < 4; k++) {
+                    float lat = 3.14159265f * ((i + (k >= 2)) / (float)stacks - 0.5f);
+                    float lon = twoPi * (j + (k == 1 || k == 2)) / slices;
+                    float x = cosf(lat) * cosf(lon), y = cosf(lat) * sinf(lon), z = sinf(lat);
+                    meshVertex(sphere, x, y, z, x, y, z);
+                }
+            }
+        }
+
+        // Octahedron with flat faces
+        BatchMeshData& octahedron = meshes[MESH_OCTAHEDRON];
+        octahedron.mode = GL_TRIANGLES;
+        for (int face = 0; face < 8; face++) {
+            float sx = (face & 1) ? -1.0f : 1.0f;
+            float sy = (face & 2) ? -1.0f : 1.0f;
+            float sz = (face & 4) ? -1.0f : 1.0f;
+            float nx = sx * 0.57735027f, ny = sy * 0.57735027f, nz = sz * 0.57735027f;
+
+            // X, Y, Z corners are counter-clockwise seen from outside when sx * sy * sz > 0
+            meshVertex(octahedron, nx, ny, nz, sx, 0, 0);
+            if (sx * sy * sz > 0.0f) {
+                meshVertex(octahedron, nx, ny, nz, 0, sy, 0);
+                meshVertex(octahedron, nx, ny, nz, 0, 0, sz);
+            } else {
+                meshVertex(octahedron, nx, ny, nz, 0, 0, sz);
+                meshVertex(octahedron, nx, ny, nz, 0, sy, 0);
+            }
+        }
+        built = true;
+    }
+    return meshes[mesh];
+}
+
+// Transformed vertices for one frame, interleaved as color (3), normal (3), position (3)
+struct MeshBatch {
+    std::vector<float> vertices[MESH_COUNT];
+    int vertexCount[MESH_COUNT] = {};
+};
+
+// Batch shared by everything drawn through scene.h
+inline MeshBatch& sceneBatch() {
+    static MeshBatch batch;
+    return batch;
+}
+
+// Queues one copy of the mesh with the given transform and color
+inline void batchAdd(MeshBatch& batch, BatchMesh mesh, const BatchTransform& t, float r, float g, float b) {
+    const BatchMeshData& source = batchMeshData(mesh);
+    const float* m = t.m;
+    int count = source.vertexCount();
+
+    std::vector<float>& out = batch.vertices[mesh];
+    size_t needed = (size_t)(batch.vertexCount[mesh] + count) * 9;
+    if (out.size() < needed) out.resize(needed * 2);
+
+    // Normals go through the inverse-transpose of the upper 3x3, i.e. its cofactor matrix
+    // divided by the determinant. Only the sign of the determinant matters, since every
+    // normal is renormalised below.
+    float c00 = m[5] * m[10] - m[9] * m[6], c01 = m[9] * m[2] - m[1] * m[10], c02 = m[1] * m[6] - m[5] * m[2];
+    float c10 = m[8] * m[6] - m[4] * m[10], c11 = m[0] * m[10] - m[8] * m[2], c12 = m[4] * m[2] - m[0] * m[6];
+    float c20 = m[4] * m[9] - m[8] * m[5], c21 = m[8] * m[1] - m[0] * m[9], c22 = m[0] * m[5] - m[4] * m[1];
+    float sign = (m[0] * c00 + m[4] * c01 + m[8] * c02) < 0.0f ? -1.0f : 1.0f;
+
+    float* dst = &out[(size_t)batch.vertexCount[mesh] * 9];
+    const float* src = source.vertices.data();
+    for (int i = 0; i < count; i++, src += 6, dst += 9) {
+        float nx = c00 * src[0] + c01 * src[1] + c02 * src[2];
+        float ny = c10 * src[0] + c11 * src[1] + c12 * src[2];
+        float nz = c20 * src[0] + c21 * src[1] + c22 * src[2];
+        float length = sqrtf(nx * nx + ny * ny + nz * nz);
+        float scale = length > 0.0f ? sign / length : 0.0f;
+
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+        dst[3] = nx * scale;
+        dst[4] = ny * scale;
+        dst[5] = nz * scale;
+        dst[6] = m[0] * src[3] + m[4] * src[4] + m[8] * src[5] + m[12];
+        dst[7] = m[1] * src[3] + m[5] * src[4] + m[9] * src[5] + m[13];
+        dst[8] = m[2] * src[3] + m[6] * src[4] + m[10] * src[5] + m[14];
+    }
+    batch.vertexCount[mesh] += count;
+}
+
+// Draws everything queued, one call per mesh type. The batch is kept, so split-screen views
+// can replay it without transforming the meshes again.
+inline void batchDraw(const MeshBatch& batch) {
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++) {
+        int count = batch.vertexCount[mesh];
+        if (count == 0) continue;
+
+        const float* data = batch.vertices[mesh].data();
+        glColorPointer(3, GL_FLOAT, 9 * sizeof(float), data);
+        glNormalPointer(GL_FLOAT, 9 * sizeof(float), data + 3);
+        glVertexPointer(3, GL_FLOAT, 9 * sizeof(float), data + 6);
+        glDrawArrays(batchMeshData((BatchMesh)mesh).mode, 0, count);
+        PROFILE_DRAW(count);
+    }
+    glPopClientAttrib();
+}
+
+// Empties the batch, keeping its capacity
+inline void batchClear(MeshBatch& batch) {
+    for (int mesh = 0; mesh < MESH_COUNT; mesh++) batch.vertexCount[mesh] = 0;
+}
+
+// Draws everything queued and empties the batch
+inline void batchFlush(MeshBatch& batch) {
+    batchDraw(batch);
+    batchClear(batch);
+}
+
+#endif
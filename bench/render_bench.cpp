@@ -0,0 +1,461 @@
+// Offscreen rendering benchmark for the Two-cars and Rocket League scenes.
+//
+// Renders through a software GL context (Mesa llvmpipe behind an EGL pbuffer), so it runs on
+// CI machines without a GPU or a display:
+//
+//   g++ -O2 -DENABLE_PROFILER -I. bench/render_bench.cpp -o render_bench -lEGL -lGL -lGLU
+//   ./render_bench --baseline bench/render_baseline.txt
+//
+// Each scene draws its own goals, ball and cars (scene.h ports both games' versions), so a
+// change to either game's geometry shows up in its own counters.
+//
+// Every scene is rendered along each scripted orbit-camera path and reports frames/sec,
+// draw calls, vertices, render state changes and CPU time per stage. With --baseline the
+// deterministic counters (draw calls, vertices, state changes) are compared against the stored
+// numbers and the exit code is 1 if any of them grew; --update-baseline rewrites the file
+// instead. Frame rates depend on the machine, so a drop against the recorded fps is only
+// reported (beyond --tolerance percent) and never fails the run.
+//
+// --views N (up to 4) renders split-screen the way Two-cars does: the scene is queued once and
+// replayed into N viewports, each following the camera path from its own side of the field.
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "../scene.h"
+#include "../render_queue.h"
+
+// Scene size knobs
+struct BenchConfig {
+    int frames = 300;
+    int width = 800, height = 600;
+    int cars = 2;
+    int tiers = 0;          // 0 = the scene's own stand height
+    int clouds = 5;
+    int views = 1;
+    float tolerance = 0.15f;
+    const char* baselinePath = NULL;
+    bool updateBaseline = false;
+};
+
+BenchConfig config;
+std::vector<Car> benchCars;
+float benchCarsX, benchCarsZ, benchCarsRadius;  // Sphere around every car, for culling
+Sky benchSky;
+
+// Scripted camera paths over the orbit camera (yaw, pitch, distance) used by the game
+struct CameraPath {
+    const char* name;
+    void (*at)(float t, float& yaw, float& pitch, float& distance);
+};
+
+void orbitPath(float t, float& yaw, float& pitch, float& distance) {
+    yaw = t * 6.2831853f;
+    pitch = 0.35f;
+    distance = 50.0f;
+}
+
+void swoopPath(float t, float& yaw, float& pitch, float& distance) {
+    yaw = t * 3.14159f;
+    pitch = 1.4f - 1.2f * t;
+    distance = 100.0f - 80.0f * t;
+}
+
+void closeupPath(float t, float& yaw, float& pitch, float& distance) {
+    yaw = -1.57f + 0.5f * sinf(t * 6.2831853f);
+    pitch = 0.15f;
+    distance = 12.0f;
+}
+
+const CameraPath cameraPaths[] = {
+    {"orbit", orbitPath},
+    {"swoop", swoopPath},
+    {"closeup", closeupPath},
+};
+
+void setupBenchCamera(float yaw, float pitch, float distance, float aspect) {
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluPerspective(45.0, aspect, 1.0, 800.0);
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    gluLookAt(distance * cosf(pitch) * sinf(yaw), distance * sinf(pitch), distance * cosf(pitch) * cosf(yaw),
+              0.0f, 0.0f, 0.0f,
+              0.0f, 1.0f, 0.0f);
+}
+
+// Lays the cars out on a grid around the centre spot, alternating red and blue
+void initBenchCars(int count) {
+    benchCars.clear();
+    int perRow = (int)ceilf(sqrtf((float)count));
+    for (int i = 0; i < count; i++) {
+        Car car = {};
+        car.x = (i % perRow - perRow * 0.5f) * 5.0f;
+        car.z = (i / perRow - perRow * 0.5f) * 3.0f;
+        car.rotation = (i % 2) ? 180.0f : 0.0f;
+        benchCars.push_back(car);
+    }
+
+    benchCarsX = benchCarsZ = benchCarsRadius = 0.0f;
+    for (int i = 0; i < count; i++) {
+        benchCarsX += benchCars[i].x / count;
+        benchCarsZ += benchCars[i].z / count;
+    }
+    for (int i = 0; i < count; i++) {
+        float dx = benchCars[i].x - benchCarsX, dz = benchCars[i].z - benchCarsZ;
+        benchCarsRadius = fmaxf(benchCarsRadius, sqrtf(dx * dx + dz * dz) + CAR_LENGTH);
+    }
+}
+
+RenderQueue benchQueue;
+
+// Render queue callbacks for both scenes. The car batch is built once per frame.
+void drawCarsItem(void*) {
+    PROFILE_SCOPE("cars");
+    batchDraw(sceneBatch());
+}
+
+void drawSkyItem(void*) {
+    PROFILE_SCOPE("clouds");
+    drawSky(benchSky);
+}
+
+void drawTwoCarsFieldItem(void*) {
+    PROFILE_SCOPE("stadium");
+    drawField();
+}
+
+void drawTwoCarsGoalsItem(void* data) {
+    PROFILE_SCOPE("stadium");
+    if (data) {
+        drawRightGoal(-15.0f, -23.5f);
+    } else {
+        drawLeftGoal(-15.0f, -12.5f);
+    }
+}
+
+void drawTwoCarsSeatsItem(void*) {
+    PROFILE_SCOPE("stadium");
+    drawSeats(config.tiers > 0 ? config.tiers : 6);
+}
+
+void drawRocketLeaguePitchItem(void*) {
+    PROFILE_SCOPE("stadium");
+    DrawFootballPitch(5.0f, 0.0f, 20.0f, 360);
+    MidCircle(5.0f, 0.0f, 3.0f, 360);
+}
+
+void drawRocketLeagueGoalsItem(void* data) {
+    PROFILE_SCOPE("stadium");
+    drawRocketLeagueGoal(-9.5f, data ? -36.5f : 0.0f);
+}
+
+void drawRocketLeagueStandsItem(void*) {
+    PROFILE_SCOPE("stadium");
+    drawStadium(config.tiers > 0 ? config.tiers : 11);
+}
+
+void drawFootballItem(void* data) {
+    drawFootball(0.0f, *(float*)data, 0.0f);
+}
+
+void drawRocketLeagueBallItem(void* data) {
+    drawRocketLeagueBall(0.0f, *(float*)data, 0.0f);
+}
+
+// Cars as one batched item around the grid, clouds blended last
+void queueCarsAndClouds() {
+    renderQueueAddBounded(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_CARS, benchCarsX, 0.0f, benchCarsZ,
+                          benchCarsRadius, drawCarsItem, NULL);
+    renderQueueAdd(benchQueue, PASS_TRANSLUCENT, MATERIAL_SPRITE, SCENE_SKY, 0.0f, 7.5f, 0.0f, drawSkyItem, NULL);
+}
+
+// Mirrors display() in Two-cars.cpp
+void queueTwoCarsScene() {
+    static float ballHeight = 0.3f;
+    static int rightGoal = 1;
+
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_FIELD, 0.0f, 0.0f, 0.0f, drawTwoCarsFieldItem, NULL);
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_GOAL, -15.0f, 3.0f, -12.5f, drawTwoCarsGoalsItem, NULL);
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_GOAL, -15.0f, 3.0f, -23.5f, drawTwoCarsGoalsItem, &rightGoal);
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_SEATS, -13.0f, 1.0f, 0.0f, drawTwoCarsSeatsItem, NULL);
+    renderQueueAddBounded(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_BALL, 0.0f, ballHeight, 0.0f, BALL_RADIUS,
+                          drawFootballItem, &ballHeight);
+    queueCarsAndClouds();
+}
+
+// Mirrors display() in Rocket League Code.txt
+void queueRocketLeagueScene() {
+    static float ballHeight = 0.7f;
+    static int rightGoal = 1;
+
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_FIELD, 5.0f, 0.0f, 0.0f, drawRocketLeaguePitchItem, NULL);
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_GOAL, -9.5f, 3.0f, 0.0f, drawRocketLeagueGoalsItem, NULL);
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_GOAL, -9.5f, 3.0f, -36.5f, drawRocketLeagueGoalsItem, &rightGoal);
+    renderQueueAdd(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_STANDS, 0.0f, 2.0f, 0.0f, drawRocketLeagueStandsItem, NULL);
+    renderQueueAddBounded(benchQueue, PASS_OPAQUE, MATERIAL_COLOR, SCENE_BALL, 0.0f, ballHeight, 0.0f,
+                          ROCKET_LEAGUE_BALL_RADIUS, drawRocketLeagueBallItem, &ballHeight);
+    queueCarsAndClouds();
+}
+
+struct BenchScene {
+    const char* name;
+    void (*queue)();
+    void (*batchCar)(MeshBatch& batch, const Car& car, bool isRed);
+};
+
+const BenchScene benchScenes[] = {
+    {"two-cars", queueTwoCarsScene, batchCar},
+    {"rocket-league", queueRocketLeagueScene, batchRocketLeagueCar},
+};
+
+// Viewport and camera of one split-screen view; each view sees the path from its own side
+void setupBenchView(int view, float yaw, float pitch, float distance) {
+    int x, y, w, h;
+    renderSplitViewport(view, config.views, config.width, config.height, x, y, w, h);
+    glViewport(x, y, w, h);
+    setupBenchCamera(yaw + view * 6.2831853f / config.views, pitch, distance, (float)w / (float)h);
+}
+
+// One frame the way Two-cars draws it: shared work once, then a replay per view
+void drawFrame(const BenchScene& scene, float yaw, float pitch, float distance) {
+    {
+        PROFILE_SCOPE("prepare");
+        updateSky(benchSky);
+        for (size_t i = 0; i < benchCars.size(); i++) {
+            scene.batchCar(sceneBatch(), benchCars[i], i % 2 == 0);
+        }
+
+        renderQueueBeginViews(benchQueue);
+        for (int view = 0; view < config.views; view++) {
+            setupBenchView(view, yaw, pitch, distance);
+            renderQueueAddView(benchQueue);
+        }
+        scene.queue();
+    }
+
+    for (int view = 0; view < config.views; view++) {
+        setupBenchView(view, yaw, pitch, distance);
+        renderQueueFlushView(benchQueue, view);
+    }
+    batchClear(sceneBatch());
+}
+
+struct BenchResult {
+    float fps;
+    int drawCalls;
+    long long vertices;
+    int stateChanges;
+};
+
+// Creates a pbuffer-backed desktop GL context without needing a window system
+bool createOffscreenContext(int w, int h) {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) return false;
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig eglConfig;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &eglConfig, 1, &configCount) || configCount == 0) return false;
+
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, w, EGL_HEIGHT, h, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(display, eglConfig, surfaceAttribs);
+    if (surface == EGL_NO_SURFACE) return false;
+
+    eglBindAPI(EGL_OPENGL_API);
+    EGLContext context = eglCreateContext(display, eglConfig, EGL_NO_CONTEXT, NULL);
+    if (context == EGL_NO_CONTEXT) return false;
+    return eglMakeCurrent(display, surface, surface, context);
+}
+
+BenchResult runBenchmark(const BenchScene& scene, const CameraPath& path) {
+    Profiler& p = profiler();
+    std::map<std::string, double> stageMs;
+    int drawCalls = 0;
+    long long vertices = 0;
+    int stateChanges = 0;
+    const int warmupFrames = 10;
+
+    long long start = 0;
+    for (int frame = -warmupFrames; frame <= config.frames; frame++) {
+        if (frame == 0) start = profilerNow();
+
+        // Closing a frame makes the previous frame's counters available
+        profilerNewFrame();
+        if (frame > 0) {
+            int last = (p.historyIndex + PROFILER_HISTORY - 1) % PROFILER_HISTORY;
+            for (int i = 0; i < p.zoneCount; i++) {
+                stageMs[p.zones[i].name] += p.zones[i].historyMs[last];
+            }
+            drawCalls = p.lastDrawCalls;
+            vertices = p.lastVertices;
+            stateChanges = p.lastStateChanges;
+        }
+        if (frame == config.frames) break;
+
+        float yaw, pitch, distance;
+        path.at(frame < 0 ? 0.0f : (float)frame / config.frames, yaw, pitch, distance);
+
+        glClearColor(135.0f / 255.0f, 206.0f / 255.0f, 235.0f / 255.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawFrame(scene, yaw, pitch, distance);
+
+        PROFILE_SCOPE("gl finish");
+        glFinish();
+    }
+    double seconds = (profilerNow() - start) / 1.0e9;
+
+    BenchResult result = { (float)(config.frames / seconds), drawCalls, vertices, stateChanges };
+    printf("%-14s %-8s %8.1f fps %6d draws %9lld verts %3d state  |", scene.name, path.name,
+           result.fps, result.drawCalls, result.vertices, result.stateChanges);
+    for (std::map<std::string, double>::iterator it = stageMs.begin(); it != stageMs.end(); ++it) {
+        printf(" %s %.3f ms", it->first.c_str(), it->second / config.frames);
+    }
+    printf("\n");
+    return result;
+}
+
+// Baseline entries are keyed by scene, camera path and scene size
+std::string baselineKey(const BenchScene& scene, const CameraPath& path) {
+    char key[128];
+    snprintf(key, sizeof(key), "%s/%s/cars%d-tiers%d-clouds%d-views%d-%dx%d", scene.name, path.name,
+             config.cars, config.tiers, config.clouds, config.views, config.width, config.height);
+    return key;
+}
+
+std::map<std::string, BenchResult> loadBaseline(const char* path) {
+    std::map<std::string, BenchResult> baseline;
+    FILE* file = fopen(path, "r");
+    if (!file) return baseline;
+
+    char line[256], key[128];
+    BenchResult result;
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%127s %f %d %lld %d", key, &result.fps, &result.drawCalls, &result.vertices,
+                   &result.stateChanges) == 5) {
+            baseline[key] = result;
+        }
+    }
+    fclose(file);
+    return baseline;
+}
+
+bool saveBaseline(const char* path, const std::map<std::string, BenchResult>& baseline) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "# scene/camera/size fps draw-calls vertices state-changes (fps is informational)\n");
+    for (std::map<std::string, BenchResult>::const_iterator it = baseline.begin(); it != baseline.end(); ++it) {
+        fprintf(file, "%s %.1f %d %lld %d\n", it->first.c_str(), it->second.fps,
+                it->second.drawCalls, it->second.vertices, it->second.stateChanges);
+    }
+    fclose(file);
+    return true;
+}
+
+void parseArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && hasValue) config.frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--width") == 0 && hasValue) config.width = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--height") == 0 && hasValue) config.height = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cars") == 0 && hasValue) config.cars = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tiers") == 0 && hasValue) config.tiers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--clouds") == 0 && hasValue) config.clouds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--views") == 0 && hasValue) config.views = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) config.tolerance = atof(argv[++i]) / 100.0f;
+        else if (strcmp(argv[i], "--baseline") == 0 && hasValue) config.baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--update-baseline") == 0) config.updateBaseline = true;
+        else {
+            printf("usage: %s [--frames N] [--width W] [--height H] [--cars N] [--tiers N] [--clouds N] [--views N]\n"
+                   "          [--baseline FILE [--update-baseline] [--tolerance PERCENT]]\n", argv[0]);
+            exit(2);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    parseArguments(argc, argv);
+    if (config.updateBaseline && !config.baselinePath) {
+        fprintf(stderr, "--update-baseline needs --baseline FILE\n");
+        return 2;
+    }
+    if (config.views < 1 || config.views > RENDER_MAX_VIEWS) {
+        fprintf(stderr, "--views must be 1 to %d\n", RENDER_MAX_VIEWS);
+        return 2;
+    }
+
+    if (!createOffscreenContext(config.width, config.height)) {
+        fprintf(stderr, "Could not create an offscreen GL context\n");
+        return 2;
+    }
+    printf("GL renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+    printf("%d frames at %dx%d, %d cars, %d clouds, %d tiers, %d views\n\n", config.frames,
+           config.width, config.height, config.cars, config.clouds, config.tiers, config.views);
+
+    glViewport(0, 0, config.width, config.height);
+    glEnable(GL_DEPTH_TEST);
+    initBenchCars(config.cars);
+    initSky(benchSky, config.clouds, 1234);
+
+    std::map<std::string, BenchResult> baseline;
+    if (config.baselinePath) baseline = loadBaseline(config.baselinePath);
+
+    int regressions = 0;
+    for (const BenchScene& scene : benchScenes) {
+        for (const CameraPath& path : cameraPaths) {
+            BenchResult result = runBenchmark(scene, path);
+            std::string key = baselineKey(scene, path);
+
+            if (config.updateBaseline) {
+                baseline[key] = result;
+                continue;
+            }
+            if (!config.baselinePath) continue;
+
+            std::map<std::string, BenchResult>::iterator stored = baseline.find(key);
+            if (stored == baseline.end()) {
+                printf("  no baseline for %s\n", key.c_str());
+                continue;
+            }
+            const BenchResult& base = stored->second;
+            if (result.fps < base.fps * (1.0f - config.tolerance)) {
+                printf("  note: %.1f fps, recorded %.1f fps (machine-dependent, not gated)\n", result.fps, base.fps);
+            }
+            if (result.drawCalls > base.drawCalls || result.vertices > base.vertices ||
+                result.stateChanges > base.stateChanges) {
+                printf("  REGRESSION: %d draws / %lld verts / %d state, baseline %d / %lld / %d\n",
+                       result.drawCalls, result.vertices, result.stateChanges,
+                       base.drawCalls, base.vertices, base.stateChanges);
+                regressions++;
+            }
+        }
+    }
+
+    if (config.updateBaseline) {
+        if (!saveBaseline(config.baselinePath, baseline)) {
+            fprintf(stderr, "Could not write %s\n", config.baselinePath);
+            return 2;
+        }
+        printf("\nBaseline written to %s\n", config.baselinePath);
+    }
+    return regressions > 0 ? 1 : 0;
+}
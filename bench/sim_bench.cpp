@@ -0,0 +1,325 @@
+// Micro-benchmarks for the simulation kernels: car physics, cloud advection, the
+// checkCollisions proximity tests, the AI state machine, network message encoding, the
+// contact solver and per-tick transient lists on the heap and on the tick arena.
+//
+// Headless, no GL needed:
+//
+//   g++ -O2 -I. bench/sim_bench.cpp -o sim_bench -pthread
+//   ./sim_bench [--quick] [--filter NAME]
+//
+// Each kernel is run at several entity counts and reports the time and throughput per unit of
+// work, named in the last column, and the number of heap allocations made per tick. Most
+// kernels do one unit per entity; checkCollisions does one proximity test per car and target
+// (every power-up plus the ball), so its cost is per test rather than per car.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <vector>
+#include "../simulation.h"
+#include "../contact_solver.h"
+#include "../game_logic.h"
+#include "../net_message.h"
+#include "../tick_arena.h"
+
+// Counts every heap allocation made by the process
+std::atomic<long long> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Keeps results alive so the optimiser can't drop the kernels
+volatile float benchSink;
+
+double minSeconds = 0.2;
+const char* filter = NULL;
+
+// Random float in [lo, hi), from a fixed-seed generator so runs are comparable
+unsigned int benchSeed = 1;
+float randomRange(float lo, float hi) {
+    benchSeed = benchSeed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((benchSeed >> 8) / 16777216.0f);
+}
+
+// ---- Kernels ----------------------------------------------------------------
+
+std::vector<Car> cars;
+Sky sky;
+std::vector<Vec2> carPositions, powerUpPositions;
+std::vector<bool> powerUpActive;
+std::vector<AIState> aiStates;
+std::vector<NetworkMessage> messages;
+std::vector<unsigned char> encoded;
+Vec2 ballPosition;
+int tickNumber;
+
+void setupCarPhysics(int count, int) {
+    cars.assign(count, Car());
+    for (int i = 0; i < count; i++) {
+        cars[i].x = randomRange(-FIELD_RADIUS, FIELD_RADIUS) * 0.5f;
+        cars[i].z = randomRange(-FIELD_RADIUS, FIELD_RADIUS) * 0.5f;
+        cars[i].rotation = randomRange(0.0f, 360.0f);
+        cars[i].isAccelerating = i % 3 != 0;
+        cars[i].isBraking = i % 3 == 0;
+        cars[i].isTurningLeft = i % 2 == 0;
+        cars[i].isTurningRight = i % 5 == 0;
+    }
+}
+
+void tickCarPhysics() {
+    for (size_t i = 0; i < cars.size(); i++) {
+        updateCarPhysics(cars[i]);
+    }
+    benchSink = cars[0].x;
+}
+
+void setupClouds(int count, int) {
+    initSky(sky, count, 1234);
+}
+
+void tickClouds() {
+    updateSky(sky);
+    benchSink = sky.x[0];
+}
+
+// Cars and power-ups scattered over the 20-unit multiplayer field
+void setupCollisions(int carCount, int powerUpCount) {
+    carPositions.resize(carCount);
+    for (int i = 0; i < carCount; i++) {
+        carPositions[i] = Vec2{randomRange(-20.0f, 20.0f), randomRange(-20.0f, 20.0f)};
+    }
+    powerUpPositions.resize(powerUpCount);
+    powerUpActive.assign(powerUpCount, true);
+    for (int i = 0; i < powerUpCount; i++) {
+        powerUpPositions[i] = Vec2{randomRange(-20.0f, 20.0f), randomRange(-20.0f, 20.0f)};
+    }
+    ballPosition = Vec2{0.0f, 0.0f};
+}
+
+// Car-target proximity tests per tick: every power-up plus the ball for each car
+long long collisionTests(int carCount, int powerUpCount) {
+    return (long long)carCount * (powerUpCount + 1);
+}
+
+// Same tests as GameWorld::checkCollisions; collected power-ups respawn at the end of the tick
+void tickCollisions() {
+    int pickups = 0, ballContacts = 0;
+    for (size_t c = 0; c < carPositions.size(); c++) {
+        for (size_t p = 0; p < powerUpPositions.size(); p++) {
+            if (powerUpActive[p] && inPickupRange(carPositions[c], powerUpPositions[p], 1.5f)) {
+                powerUpActive[p] = false;
+                pickups++;
+            }
+        }
+        if (inPickupRange(carPositions[c], ballPosition, 2.0f)) {
+            ballContacts++;
+        }
+    }
+    if (pickups > 0) powerUpActive.assign(powerUpActive.size(), true);
+    benchSink = (float)(pickups + ballContacts);
+}
+
+void setupAI(int count, int) {
+    setupCollisions(count, 0);
+    aiStates.assign(count, AIState::CHASE_BALL);
+    tickNumber = 0;
+}
+
+// AIController::updateState for every AI car, with the ball moving around the field
+void tickAI() {
+    tickNumber++;
+    ballPosition = Vec2{cosf(tickNumber * 0.05f) * 15.0f, sinf(tickNumber * 0.05f) * 15.0f};
+    bool teamInDanger = (tickNumber / 30) % 2 == 1;
+
+    for (size_t i = 0; i < aiStates.size(); i++) {
+        float ballDist = distance(carPositions[i], ballPosition);
+        aiStates[i] = nextAIState(aiStates[i], ballDist, teamInDanger);
+    }
+    benchSink = (float)aiStates[0];
+}
+
+void setupMessages(int count, int) {
+    messages.resize(count);
+    for (int i = 0; i < count; i++) {
+        messages[i].type = (MessageType)(i % MESSAGE_TYPE_COUNT);
+        messages[i].playerId = i % 4;   // GameConstants::MAX_PLAYERS
+        messages[i].x = randomRange(-20.0f, 20.0f);
+        messages[i].y = 0.0f;
+        messages[i].z = randomRange(-20.0f, 20.0f);
+        messages[i].rotation = randomRange(0.0f, 360.0f);
+        messages[i].data = i;
+    }
+    encoded.resize((size_t)count * ENCODED_MESSAGE_SIZE);
+}
+
+// Encode every message, then decode it again as the receiver would
+void tickMessages() {
+    for (size_t i = 0; i < messages.size(); i++) {
+        encodeMessage(messages[i], &encoded[i * ENCODED_MESSAGE_SIZE]);
+    }
+    float sum = 0.0f;
+    NetworkMessage msg;
+    for (size_t i = 0; i < messages.size(); i++) {
+        if (decodeMessage(&encoded[i * ENCODED_MESSAGE_SIZE], ENCODED_MESSAGE_SIZE, msg)) {
+            sum += msg.x;
+        }
+    }
+    benchSink = sum;
+}
+
+ContactSolver contactSolver;
+WorkerPool contactPool(defaultWorkerCount());
+Football football;
+
+void tickContacts() {
+    for (size_t i = 0; i < cars.size(); i++) {
+        updateCarControls(cars[i]);
+    }
+    stepContacts(contactSolver, cars.data(), (int)cars.size(), &football, &contactPool);
+    benchSink = football.x;
+}
+
+// Free-for-all pile-up: every car starts on a ring and drives flat out at the centre.
+// The setup runs long enough for the pile to form, so the ticks measure a settled jam.
+void setupContacts(int count, int) {
+    contactSolver.fieldRadius = fmaxf(20.0f, sqrtf((float)count) * 4.0f);
+    float ring = contactSolver.fieldRadius * 0.6f;
+    cars.assign(count, Car());
+    for (int i = 0; i < count; i++) {
+        float angle = i * 6.2831853f / count;
+        cars[i].x = ring * sinf(angle);
+        cars[i].z = ring * cosf(angle);
+        cars[i].rotation = angle * 180.0f / 3.14159265f + 180.0f + randomRange(-20.0f, 20.0f);
+        cars[i].isAccelerating = true;
+    }
+    football = Football{0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 300; i++) tickContacts();
+}
+
+// Per-tick transient data as GameWorld builds it: the player list for checkCollisions and a
+// short path per car for the AI. The heap version allocates every tick, the arena one doesn't.
+const int PATH_NODES = 16;
+TickArena benchArena;
+
+void setupTransient(int count, int) {
+    setupCarPhysics(count, 0);
+}
+
+void tickTransientHeap() {
+    std::vector<Car*> players;
+    for (size_t i = 0; i < cars.size(); i++) players.push_back(&cars[i]);
+
+    float sum = 0.0f;
+    for (Car* car : players) {
+        std::vector<Vec2> path;
+        for (int n = 0; n < PATH_NODES; n++) path.push_back(Vec2{car->x + n, car->z});
+        sum += path.back().x;
+    }
+    benchSink = sum;
+}
+
+void tickTransientArena() {
+    TickScope tick(benchArena);
+    ArenaVector<Car*> players = arenaVector<Car*>(benchArena, cars.size());
+    for (size_t i = 0; i < cars.size(); i++) players.push_back(&cars[i]);
+
+    float sum = 0.0f;
+    for (Car* car : players) {
+        ArenaVector<Vec2> path = arenaVector<Vec2>(benchArena, PATH_NODES);
+        for (int n = 0; n < PATH_NODES; n++) path.push_back(Vec2{car->x + n, car->z});
+        sum += path.back().x;
+    }
+    benchSink = sum;
+}
+
+// ---- Harness ----------------------------------------------------------------
+
+struct Kernel {
+    const char* name;
+    void (*setup)(int count, int secondaryCount);
+    void (*tick)();
+    const char* unit;                                       // What one unit of work is
+    long long (*units)(int count, int secondaryCount);      // Units per tick; NULL = count
+};
+
+const Kernel kernels[] = {
+    {"car physics", setupCarPhysics, tickCarPhysics, "car", NULL},
+    {"cloud advection", setupClouds, tickClouds, "cloud", NULL},
+    {"checkCollisions", setupCollisions, tickCollisions, "car-target test", collisionTests},
+    {"AI updateState", setupAI, tickAI, "AI car", NULL},
+    {"message encode", setupMessages, tickMessages, "message", NULL},
+    {"contact solver", setupContacts, tickContacts, "car", NULL},
+    {"transient heap", setupTransient, tickTransientHeap, "car", NULL},
+    {"transient arena", setupTransient, tickTransientArena, "car", NULL},
+};
+
+void runKernel(const Kernel& kernel, int count, int secondaryCount) {
+    benchSeed = 1;
+    kernel.setup(count, secondaryCount);
+    for (int i = 0; i < 3; i++) kernel.tick();
+
+    long long ticks = 0;
+    long long allocationsBefore = allocationCount.load();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    while (seconds < minSeconds || ticks < 5) {
+        kernel.tick();
+        ticks++;
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    double allocationsPerTick = (double)(allocationCount.load() - allocationsBefore) / ticks;
+
+    char label[64];
+    if (secondaryCount > 0) {
+        snprintf(label, sizeof(label), "%d x %d", count, secondaryCount);
+    } else {
+        snprintf(label, sizeof(label), "%d", count);
+    }
+    double units = kernel.units ? (double)kernel.units(count, secondaryCount) : count;
+    printf("%-18s %14s %12.2f %14.2f %12.2f  %s\n", kernel.name, label, seconds * 1e9 / ticks / units,
+           units * ticks / seconds / 1e6, allocationsPerTick, kernel.unit);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) minSeconds = 0.02;
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else {
+            printf("usage: %s [--quick] [--filter NAME]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const int carCounts[] = {2, 16, 128, 1024, 10000};
+    const int powerUpCounts[] = {3, 30, 300, 1000};
+    const int pileUpCounts[] = {2, 8, 32, 128};     // Pairs are tested all against all
+
+    printf("%-18s %14s %12s %14s %12s  %s\n", "kernel", "entities", "ns/unit", "Munits/s", "allocs/tick", "unit");
+    for (const Kernel& kernel : kernels) {
+        if (filter && !strstr(kernel.name, filter)) continue;
+
+        if (kernel.setup == setupContacts) {
+            for (int count : pileUpCounts) runKernel(kernel, count, 0);
+            continue;
+        }
+
+        for (int count : carCounts) {
+            if (kernel.setup == setupCollisions) {
+                for (int powerUps : powerUpCounts) runKernel(kernel, count, powerUps);
+            } else {
+                runKernel(kernel, count, 0);
+            }
+        }
+    }
+    return 0;
+}
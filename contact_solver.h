@@ -0,0 +1,518 @@
+#ifndef CONTACT_SOLVER_H
+#define CONTACT_SOLVER_H
+
+// Collisions between cars, the ball and the round field wall.
+//
+// Each tick, stepContacts() turns the cars into 2D oriented boxes (CAR_LENGTH x CAR_WIDTH) and
+// the ball into a circle, on the ground plane. It finds every pair that overlaps or is about to
+// (closer than SPECULATIVE_DISTANCE) and every body at the wall, then resolves the contacts with
+// sequential impulses: restitution and friction on the velocities, then a separate
+// pseudo-velocity pass that pushes overlapping bodies apart without adding energy. A contact
+// that is still a gap only stops the bodies from closing it within this tick, so fast cars
+// don't sink deep into each other before the solver sees them. Bodies that touch, directly or through others, form an
+// island. Islands share no bodies, so each one is solved as its own task on the worker pool.
+//
+// Velocities are in units per tick and spins in radians per tick, like Car::speed.
+
+#include <math.h>
+#include <vector>
+#include "simulation.h"
+#include "worker_pool.h"
+
+const float CAR_MASS = 1.0f;
+const float BALL_MASS = 0.2f;
+const float CAR_RESTITUTION = 0.2f;
+const float BALL_RESTITUTION = 0.7f;
+const float WALL_RESTITUTION = 0.3f;
+const float CONTACT_FRICTION = 0.3f;
+const float PUSH_DAMPING = 0.85f;       // Share of a car's knock-back and spin kept each tick
+const float BALL_DAMPING = 0.99f;       // Rolling resistance
+const float SPECULATIVE_DISTANCE = 2.0f * MAX_SPEED;   // Two cars closing at full speed in one tick
+const float PENETRATION_SLOP = 0.01f;   // Overlap left alone so resting contacts don't jitter
+const float POSITION_CORRECTION = 0.2f; // Share of the remaining overlap removed per tick
+const int VELOCITY_ITERATIONS = 8;
+const int POSITION_ITERATIONS = 3;
+const int PARALLEL_MIN_CONTACTS = 32;   // Below this the islands are solved on the calling thread
+
+struct ContactBody {
+    float x, z;
+    float vx, vz, w;            // Velocity and spin
+    float px, pz, pw;           // Pseudo-velocity from overlap correction, dropped after the step
+    float ax, az, bx, bz;       // Box length and width axes
+    float halfLength, halfWidth;
+    float radius;               // > 0 for the ball, which is a circle
+    float invMass, invInertia;
+    float restitution;
+};
+
+struct Contact {
+    int a, b;                   // Body indices; b is -1 for the field wall
+    float nx, nz;               // Unit normal pointing from a towards b
+    float x, z;                 // Contact point
+    float penetration;          // Negative while the bodies are still apart
+
+    // Filled in by the solver
+    float rax, raz, rbx, rbz;
+    float normalMass, tangentMass;
+    float restitutionTarget;
+    float normalImpulse, tangentImpulse, positionImpulse;
+};
+
+// Scratch state kept between ticks so a step does not allocate once it has warmed up
+struct ContactSolver {
+    float fieldRadius = FIELD_RADIUS;
+    std::vector<ContactBody> bodies;
+    std::vector<Contact> contacts;
+
+    // Islands: contact indices grouped by island, islandStart[i]..islandStart[i + 1]
+    std::vector<int> parent;
+    std::vector<int> islandOf;
+    std::vector<int> islandStart;
+    std::vector<int> islandContacts;
+    std::vector<int> islandCursor;
+    int islandCount = 0;
+};
+
+// ---- Narrowphase -------------------------------------------------------------
+
+// Half the box's extent along direction (nx, nz)
+inline float boxExtent(const ContactBody& box, float nx, float nz) {
+    return box.halfLength * fabsf(box.ax * nx + box.az * nz) + box.halfWidth * fabsf(box.bx * nx + box.bz * nz);
+}
+
+inline void addContact(ContactSolver& solver, int a, int b, float nx, float nz, float x, float z, float penetration) {
+    Contact c;
+    c.a = a;
+    c.b = b;
+    c.nx = nx;
+    c.nz = nz;
+    c.x = x;
+    c.z = z;
+    c.penetration = penetration;
+    c.normalImpulse = c.tangentImpulse = c.positionImpulse = 0.0f;
+    solver.contacts.push_back(c);
+}
+
+// Separating axis test on the four box axes. The box owning the axis of least overlap is the
+// reference; the face of the other box that points back at it is clipped to the reference
+// face, giving up to two contact points so touching edges don't rock on a single corner.
+inline void collideBoxes(ContactSolver& solver, int ia, int ib) {
+    const ContactBody& a = solver.bodies[ia];
+    const ContactBody& b = solver.bodies[ib];
+    float dx = b.x - a.x, dz = b.z - a.z;
+
+    const float axes[4][2] = {{a.ax, a.az}, {a.bx, a.bz}, {b.ax, b.az}, {b.bx, b.bz}};
+    int bestAxis = -1;
+    float bestSeparation = -1e30f;
+    for (int i = 0; i < 4; i++) {
+        float nx = axes[i][0], nz = axes[i][1];
+        float separation = fabsf(dx * nx + dz * nz) - boxExtent(a, nx, nz) - boxExtent(b, nx, nz);
+        if (separation > SPECULATIVE_DISTANCE) return;
+        if (separation > bestSeparation) {
+            bestSeparation = separation;
+            bestAxis = i;
+        }
+    }
+
+    // Normal from a to b, and from the reference box to the incident one
+    float nx = axes[bestAxis][0], nz = axes[bestAxis][1];
+    if (dx * nx + dz * nz < 0.0f) {
+        nx = -nx;
+        nz = -nz;
+    }
+    bool referenceIsA = bestAxis < 2;
+    const ContactBody& ref = referenceIsA ? a : b;
+    const ContactBody& inc = referenceIsA ? b : a;
+    float rnx = referenceIsA ? nx : -nx, rnz = referenceIsA ? nz : -nz;
+    float tx = -rnz, tz = rnx;
+
+    float faceDistance = rnx * ref.x + rnz * ref.z + boxExtent(ref, rnx, rnz);
+    float faceCentre = tx * ref.x + tz * ref.z;
+    float faceHalf = boxExtent(ref, tx, tz);
+
+    // Incident face: the one whose outward normal is most against the reference normal
+    float alongA = inc.ax * rnx + inc.az * rnz, alongB = inc.bx * rnx + inc.bz * rnz;
+    float fx, fz, edgeX, edgeZ, edgeHalf;
+    if (fabsf(alongA) > fabsf(alongB)) {
+        float s = alongA > 0.0f ? -inc.halfLength : inc.halfLength;
+        fx = inc.x + s * inc.ax;
+        fz = inc.z + s * inc.az;
+        edgeX = inc.bx;
+        edgeZ = inc.bz;
+        edgeHalf = inc.halfWidth;
+    } else {
+        float s = alongB > 0.0f ? -inc.halfWidth : inc.halfWidth;
+        fx = inc.x + s * inc.bx;
+        fz = inc.z + s * inc.bz;
+        edgeX = inc.ax;
+        edgeZ = inc.az;
+        edgeHalf = inc.halfLength;
+    }
+
+    // Clip the incident edge to the reference face's width
+    float p0x = fx - edgeX * edgeHalf, p0z = fz - edgeZ * edgeHalf;
+    float p1x = fx + edgeX * edgeHalf, p1z = fz + edgeZ * edgeHalf;
+    float t0 = tx * p0x + tz * p0z - faceCentre, t1 = tx * p1x + tz * p1z - faceCentre;
+    float lo = -faceHalf, hi = faceHalf;
+    if ((t0 < lo && t1 < lo) || (t0 > hi && t1 > hi)) return;
+    if (t0 != t1) {
+        float c0 = fmaxf(lo, fminf(hi, t0)), c1 = fmaxf(lo, fminf(hi, t1));
+        float u0 = (c0 - t0) / (t1 - t0), u1 = (c1 - t0) / (t1 - t0);
+        float q0x = p0x + (p1x - p0x) * u0, q0z = p0z + (p1z - p0z) * u0;
+        float q1x = p0x + (p1x - p0x) * u1, q1z = p0z + (p1z - p0z) * u1;
+        p0x = q0x;
+        p0z = q0z;
+        p1x = q1x;
+        p1z = q1z;
+    }
+
+    float depth0 = faceDistance - (rnx * p0x + rnz * p0z);
+    float depth1 = faceDistance - (rnx * p1x + rnz * p1z);
+    if (depth0 > -SPECULATIVE_DISTANCE) addContact(solver, ia, ib, nx, nz, p0x, p0z, depth0);
+    if (depth1 > -SPECULATIVE_DISTANCE) addContact(solver, ia, ib, nx, nz, p1x, p1z, depth1);
+}
+
+// Closest point on the box to the circle's centre
+inline void collideBoxCircle(ContactSolver& solver, int ibox, int icircle) {
+    const ContactBody& box = solver.bodies[ibox];
+    const ContactBody& circle = solver.bodies[icircle];
+    float dx = circle.x - box.x, dz = circle.z - box.z;
+    float u = dx * box.ax + dz * box.az;
+    float v = dx * box.bx + dz * box.bz;
+    float cu = fmaxf(-box.halfLength, fminf(box.halfLength, u));
+    float cv = fmaxf(-box.halfWidth, fminf(box.halfWidth, v));
+    float px = box.x + cu * box.ax + cv * box.bx;
+    float pz = box.z + cu * box.az + cv * box.bz;
+
+    float ex = circle.x - px, ez = circle.z - pz;
+    float distSq = ex * ex + ez * ez;
+    float reach = circle.radius + SPECULATIVE_DISTANCE;
+    if (distSq > reach * reach) return;
+
+    if (distSq > 1e-12f) {
+        float dist = sqrtf(distSq);
+        addContact(solver, ibox, icircle, ex / dist, ez / dist, px, pz, circle.radius - dist);
+    } else {
+        // Centre inside the box: leave through the nearest face
+        float exitU = box.halfLength - fabsf(u), exitV = box.halfWidth - fabsf(v);
+        float nx, nz, depth;
+        if (exitU < exitV) {
+            float s = u < 0.0f ? -1.0f : 1.0f;
+            nx = s * box.ax;
+            nz = s * box.az;
+            depth = exitU;
+        } else {
+            float s = v < 0.0f ? -1.0f : 1.0f;
+            nx = s * box.bx;
+            nz = s * box.bz;
+            depth = exitV;
+        }
+        addContact(solver, ibox, icircle, nx, nz, circle.x, circle.z, circle.radius + depth);
+    }
+}
+
+// Box corners or the circle against the inside of the round field wall
+inline void collideWall(ContactSolver& solver, int index) {
+    const ContactBody& body = solver.bodies[index];
+    float limit = solver.fieldRadius;
+
+    if (body.radius > 0.0f) {
+        float dist = sqrtf(body.x * body.x + body.z * body.z);
+        if (dist + body.radius > limit - SPECULATIVE_DISTANCE && dist > 1e-6f) {
+            float nx = body.x / dist, nz = body.z / dist;
+            addContact(solver, index, -1, nx, nz, body.x + nx * body.radius, body.z + nz * body.radius,
+                       dist + body.radius - limit);
+        }
+        return;
+    }
+
+    for (int corner = 0; corner < 4; corner++) {
+        float sa = (corner & 1) ? -1.0f : 1.0f;
+        float sb = (corner & 2) ? -1.0f : 1.0f;
+        float x = body.x + sa * body.halfLength * body.ax + sb * body.halfWidth * body.bx;
+        float z = body.z + sa * body.halfLength * body.az + sb * body.halfWidth * body.bz;
+        float dist = sqrtf(x * x + z * z);
+        if (dist > limit - SPECULATIVE_DISTANCE) {
+            addContact(solver, index, -1, x / dist, z / dist, x, z, dist - limit);
+        }
+    }
+}
+
+// ---- Islands -----------------------------------------------------------------
+
+inline int findIsland(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Groups the contacts into islands of bodies connected through contacts. The wall is static,
+// so it does not join the bodies touching it into one island.
+inline void buildIslands(ContactSolver& solver) {
+    int bodyCount = (int)solver.bodies.size();
+    solver.parent.resize(bodyCount);
+    for (int i = 0; i < bodyCount; i++) solver.parent[i] = i;
+
+    for (size_t i = 0; i < solver.contacts.size(); i++) {
+        const Contact& c = solver.contacts[i];
+        if (c.b < 0) continue;
+        int ra = findIsland(solver.parent, c.a), rb = findIsland(solver.parent, c.b);
+        if (ra != rb) solver.parent[ra] = rb;
+    }
+
+    // Number the islands that have contacts, then bucket the contacts by island
+    solver.islandOf.assign(bodyCount, -1);
+    solver.islandCount = 0;
+    for (size_t i = 0; i < solver.contacts.size(); i++) {
+        int root = findIsland(solver.parent, solver.contacts[i].a);
+        if (solver.islandOf[root] < 0) solver.islandOf[root] = solver.islandCount++;
+    }
+
+    solver.islandStart.assign(solver.islandCount + 1, 0);
+    for (size_t i = 0; i < solver.contacts.size(); i++) {
+        solver.islandStart[solver.islandOf[findIsland(solver.parent, solver.contacts[i].a)] + 1]++;
+    }
+    for (int i = 0; i < solver.islandCount; i++) solver.islandStart[i + 1] += solver.islandStart[i];
+
+    solver.islandContacts.resize(solver.contacts.size());
+    solver.islandCursor.assign(solver.islandStart.begin(), solver.islandStart.end() - 1);
+    for (size_t i = 0; i < solver.contacts.size(); i++) {
+        int island = solver.islandOf[findIsland(solver.parent, solver.contacts[i].a)];
+        solver.islandContacts[solver.islandCursor[island]++] = (int)i;
+    }
+}
+
+// ---- Solver ------------------------------------------------------------------
+
+// Effective mass of an impulse along (nx, nz) at the contact's offsets
+inline float contactMass(const ContactBody& a, const ContactBody* b, const Contact& c, float nx, float nz) {
+    float rnA = c.raz * nx - c.rax * nz;
+    float k = a.invMass + a.invInertia * rnA * rnA;
+    if (b) {
+        float rnB = c.rbz * nx - c.rbx * nz;
+        k += b->invMass + b->invInertia * rnB * rnB;
+    }
+    return k > 0.0f ? 1.0f / k : 0.0f;
+}
+
+// Velocity of b relative to a at the contact point, from (vx, vz, w) or the pseudo-velocity
+inline void relativeVelocity(const ContactBody& a, const ContactBody* b, const Contact& c, bool pseudo,
+                             float& rx, float& rz) {
+    float avx = pseudo ? a.px : a.vx, avz = pseudo ? a.pz : a.vz, aw = pseudo ? a.pw : a.w;
+    rx = -(avx + aw * c.raz);
+    rz = -(avz - aw * c.rax);
+    if (b) {
+        float bvx = pseudo ? b->px : b->vx, bvz = pseudo ? b->pz : b->vz, bw = pseudo ? b->pw : b->w;
+        rx += bvx + bw * c.rbz;
+        rz += bvz - bw * c.rbx;
+    }
+}
+
+// Applies impulse (jx, jz) to b and its opposite to a
+inline void applyImpulse(ContactBody& a, ContactBody* b, const Contact& c, bool pseudo, float jx, float jz) {
+    float& avx = pseudo ? a.px : a.vx;
+    float& avz = pseudo ? a.pz : a.vz;
+    float& aw = pseudo ? a.pw : a.w;
+    avx -= a.invMass * jx;
+    avz -= a.invMass * jz;
+    aw -= a.invInertia * (c.raz * jx - c.rax * jz);
+    if (b) {
+        float& bvx = pseudo ? b->px : b->vx;
+        float& bvz = pseudo ? b->pz : b->vz;
+        float& bw = pseudo ? b->pw : b->w;
+        bvx += b->invMass * jx;
+        bvz += b->invMass * jz;
+        bw += b->invInertia * (c.rbz * jx - c.rbx * jz);
+    }
+}
+
+inline void solveIsland(ContactSolver& solver, int island) {
+    ContactBody* bodies = solver.bodies.data();
+    const int* order = &solver.islandContacts[solver.islandStart[island]];
+    int count = solver.islandStart[island + 1] - solver.islandStart[island];
+
+    for (int i = 0; i < count; i++) {
+        Contact& c = solver.contacts[order[i]];
+        ContactBody& a = bodies[c.a];
+        ContactBody* b = c.b >= 0 ? &bodies[c.b] : NULL;
+        c.rax = c.x - a.x;
+        c.raz = c.z - a.z;
+        c.rbx = b ? c.x - b->x : 0.0f;
+        c.rbz = b ? c.z - b->z : 0.0f;
+        c.normalMass = contactMass(a, b, c, c.nx, c.nz);
+        c.tangentMass = contactMass(a, b, c, -c.nz, c.nx);
+
+        // Bounce back with a share of the approach speed once touching; before that, only
+        // allow closing the gap
+        float rx, rz;
+        relativeVelocity(a, b, c, false, rx, rz);
+        float approach = rx * c.nx + rz * c.nz;
+        float restitution = fmaxf(a.restitution, b ? b->restitution : WALL_RESTITUTION);
+        if (c.penetration < 0.0f) {
+            c.restitutionTarget = c.penetration;
+        } else {
+            c.restitutionTarget = approach < -0.01f ? -restitution * approach : 0.0f;
+        }
+    }
+
+    for (int iteration = 0; iteration < VELOCITY_ITERATIONS; iteration++) {
+        for (int i = 0; i < count; i++) {
+            Contact& c = solver.contacts[order[i]];
+            ContactBody& a = bodies[c.a];
+            ContactBody* b = c.b >= 0 ? &bodies[c.b] : NULL;
+            float rx, rz;
+
+            // Friction, limited by the normal impulse from the previous iteration
+            float tx = -c.nz, tz = c.nx;
+            relativeVelocity(a, b, c, false, rx, rz);
+            float limit = CONTACT_FRICTION * c.normalImpulse;
+            float tangent = c.tangentImpulse - c.tangentMass * (rx * tx + rz * tz);
+            tangent = fmaxf(-limit, fminf(limit, tangent));
+            float dt = tangent - c.tangentImpulse;
+            c.tangentImpulse = tangent;
+            applyImpulse(a, b, c, false, dt * tx, dt * tz);
+
+            // Normal impulse, never pulling the bodies together
+            relativeVelocity(a, b, c, false, rx, rz);
+            float normal = c.normalImpulse + c.normalMass * (c.restitutionTarget - (rx * c.nx + rz * c.nz));
+            normal = fmaxf(0.0f, normal);
+            float dn = normal - c.normalImpulse;
+            c.normalImpulse = normal;
+            applyImpulse(a, b, c, false, dn * c.nx, dn * c.nz);
+        }
+    }
+
+    // Separate overlapping bodies through the pseudo-velocity only
+    for (int iteration = 0; iteration < POSITION_ITERATIONS; iteration++) {
+        for (int i = 0; i < count; i++) {
+            Contact& c = solver.contacts[order[i]];
+            ContactBody& a = bodies[c.a];
+            ContactBody* b = c.b >= 0 ? &bodies[c.b] : NULL;
+            float target = POSITION_CORRECTION * fmaxf(0.0f, c.penetration - PENETRATION_SLOP);
+            float rx, rz;
+            relativeVelocity(a, b, c, true, rx, rz);
+            float impulse = c.positionImpulse + c.normalMass * (target - (rx * c.nx + rz * c.nz));
+            impulse = fmaxf(0.0f, impulse);
+            float dp = impulse - c.positionImpulse;
+            c.positionImpulse = impulse;
+            applyImpulse(a, b, c, true, dp * c.nx, dp * c.nz);
+        }
+    }
+}
+
+inline void solveIslandTask(void* context, int island) {
+    solveIsland(*(ContactSolver*)context, island);
+}
+
+// Fills in a body from a car; its velocity is the driving speed plus any knock-back
+inline ContactBody carBody(const Car& car) {
+    float r = car.rotation * (float)M_PI / 180.0f;
+    float c = cosf(r), s = sinf(r);
+
+    ContactBody body;
+    body.x = car.x;
+    body.z = car.z;
+    body.vx = car.speed * s + car.pushX;
+    body.vz = car.speed * c + car.pushZ;
+    body.w = car.spin;
+    body.px = body.pz = body.pw = 0.0f;
+    body.ax = c;                // Length axis, same as the drawn car (scaled along local X)
+    body.az = -s;
+    body.bx = s;                // Width axis, the direction the car drives in
+    body.bz = c;
+    body.halfLength = CAR_LENGTH * 0.5f;
+    body.halfWidth = CAR_WIDTH * 0.5f;
+    body.radius = 0.0f;
+    body.invMass = 1.0f / CAR_MASS;
+    body.invInertia = 12.0f / (CAR_MASS * (CAR_LENGTH * CAR_LENGTH + CAR_WIDTH * CAR_WIDTH));
+    body.restitution = CAR_RESTITUTION;
+    return body;
+}
+
+inline ContactBody ballBody(const Football& ball) {
+    ContactBody body;
+    body.x = ball.x;
+    body.z = ball.z;
+    body.vx = ball.vx;
+    body.vz = ball.vz;
+    body.w = 0.0f;
+    body.px = body.pz = body.pw = 0.0f;
+    body.ax = 1.0f;
+    body.az = 0.0f;
+    body.bx = 0.0f;
+    body.bz = 1.0f;
+    body.halfLength = body.halfWidth = 0.0f;
+    body.radius = BALL_RADIUS;
+    body.invMass = 1.0f / BALL_MASS;
+    body.invInertia = 0.0f;     // The ball's spin isn't simulated
+    body.restitution = BALL_RESTITUTION;
+    return body;
+}
+
+// Moves the cars (after updateCarControls()) and the ball through one tick, resolving every
+// collision on the way. pool may be NULL to solve on the calling thread.
+inline void stepContacts(ContactSolver& solver, Car* cars, int carCount, Football* ball, WorkerPool* pool) {
+    solver.bodies.clear();
+    solver.contacts.clear();
+    for (int i = 0; i < carCount; i++) solver.bodies.push_back(carBody(cars[i]));
+    if (ball) solver.bodies.push_back(ballBody(*ball));
+
+    // Pairs whose bounding circles overlap, then the wall
+    int bodyCount = (int)solver.bodies.size();
+    const float carReach = sqrtf(CAR_LENGTH * CAR_LENGTH + CAR_WIDTH * CAR_WIDTH) * 0.5f + SPECULATIVE_DISTANCE;
+    for (int i = 0; i < bodyCount; i++) {
+        const ContactBody& a = solver.bodies[i];
+        float reachA = a.radius > 0.0f ? a.radius : carReach;
+        for (int j = i + 1; j < bodyCount; j++) {
+            const ContactBody& b = solver.bodies[j];
+            float reach = reachA + (b.radius > 0.0f ? b.radius : carReach);
+            float dx = b.x - a.x, dz = b.z - a.z;
+            if (dx * dx + dz * dz > reach * reach) continue;
+
+            if (a.radius > 0.0f) {
+                collideBoxCircle(solver, j, i);
+            } else if (b.radius > 0.0f) {
+                collideBoxCircle(solver, i, j);
+            } else {
+                collideBoxes(solver, i, j);
+            }
+        }
+        collideWall(solver, i);
+    }
+
+    buildIslands(solver);
+    if (pool && solver.islandCount > 1 && (int)solver.contacts.size() >= PARALLEL_MIN_CONTACTS) {
+        pool->parallelFor(solver.islandCount, solveIslandTask, &solver);
+    } else {
+        for (int i = 0; i < solver.islandCount; i++) solveIsland(solver, i);
+    }
+
+    // Integrate, then hand the result back to the cars and the ball
+    const float degrees = 180.0f / (float)M_PI;
+    for (int i = 0; i < carCount; i++) {
+        const ContactBody& body = solver.bodies[i];
+        Car& car = cars[i];
+        car.x = body.x + body.vx + body.px;
+        car.z = body.z + body.vz + body.pz;
+        car.rotation += (body.w + body.pw) * degrees;
+
+        // Velocity along the heading stays driving speed; the rest is knock-back that dies down
+        float r = car.rotation * (float)M_PI / 180.0f;
+        float hx = sinf(r), hz = cosf(r);
+        car.speed = body.vx * hx + body.vz * hz;
+        car.pushX = (body.vx - car.speed * hx) * PUSH_DAMPING;
+        car.pushZ = (body.vz - car.speed * hz) * PUSH_DAMPING;
+        car.spin = body.w * PUSH_DAMPING;
+    }
+    if (ball) {
+        const ContactBody& body = solver.bodies[carCount];
+        ball->x = body.x + body.vx + body.px;
+        ball->z = body.z + body.vz + body.pz;
+        ball->vx = body.vx * BALL_DAMPING;
+        ball->vz = body.vz * BALL_DAMPING;
+    }
+}
+
+#endif
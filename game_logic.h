@@ -0,0 +1,61 @@
+#ifndef GAME_LOGIC_H
+#define GAME_LOGIC_H
+
+// GL-free game rules used by the multiplayer GameWorld (main.cpp) and the simulation benchmark
+
+#include <math.h>
+
+enum class PowerUpType {
+    SPEED_BOOST,
+    SHIELD,
+    BALL_MAGNET,
+    GOAL_MULTIPLIER
+};
+
+enum class AIState {
+    CHASE_BALL,
+    DEFEND,
+    SUPPORT_ATTACK,
+    RETURN_TO_POSITION,
+    AVOID_OBSTACLE
+};
+
+// Position on the field plane
+struct Vec2 { float x, z; };
+
+inline float distance(Vec2 a, Vec2 b) {
+    float dx = a.x - b.x, dz = a.z - b.z;
+    return sqrtf(dx * dx + dz * dz);
+}
+
+// Proximity test used for power-up pickups and ball contact, without the square root
+inline bool inPickupRange(Vec2 a, Vec2 b, float radius) {
+    float dx = a.x - b.x, dz = a.z - b.z;
+    return dx * dx + dz * dz < radius * radius;
+}
+
+// AI state machine transitions
+inline AIState nextAIState(AIState current, float ballDist, bool teamInDanger) {
+    switch (current) {
+        case AIState::CHASE_BALL:
+            if (ballDist > 15.0f) {
+                return AIState::RETURN_TO_POSITION;
+            } else if (teamInDanger) {
+                return AIState::DEFEND;
+            }
+            break;
+
+        case AIState::DEFEND:
+            if (!teamInDanger && ballDist < 10.0f) {
+                return AIState::CHASE_BALL;
+            }
+            break;
+
+        // Add more state transitions
+        default:
+            break;
+    }
+    return current;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// Timestamped input events.
+//
+// The GLUT callbacks only push events into an InputQueue. The fixed-step simulation drains
+// every event stamped before the end of the tick it is about to run, so a key press always
+// lands in the same tick whatever the frame rate. That ordering is also what replay and
+// networking need.
+
+#include <atomic>
+#include <chrono>
+
+enum class InputEventType : unsigned char {
+    KEY_DOWN,
+    KEY_UP,
+    SPECIAL_DOWN,
+    SPECIAL_UP
+};
+
+struct InputEvent {
+    long long timestampNs;      // When the event reached the callback, on inputClockNs()
+    InputEventType type;
+    int key;                    // ASCII key or GLUT_KEY_* code
+};
+
+// Monotonic clock shared by the input layer, the simulation and the profiler
+inline long long inputClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Lock-free single-producer/single-consumer ring buffer.
+// Capacity must be a power of two.
+template <unsigned int Capacity>
+class InputQueue {
+private:
+    InputEvent events[Capacity];
+    std::atomic<unsigned int> head{0};   // Next event to read (consumer)
+    std::atomic<unsigned int> tail{0};   // Next free slot (producer)
+
+public:
+    // Returns false and drops the event if the queue is full
+    bool push(InputEventType type, int key) {
+        unsigned int t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+
+        events[t & (Capacity - 1)] = {inputClockNs(), type, key};
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops the oldest event if it happened at or before timeNs
+    bool popUntil(long long timeNs, InputEvent& event) {
+        unsigned int h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        const InputEvent& next = events[h & (Capacity - 1)];
+        if (next.timestampNs > timeNs) return false;
+
+        event = next;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif
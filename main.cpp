@@ -2,6 +2,7 @@
 #include <GL/gl.h>
 #include <GL/glu.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <vector>
@@ -11,7 +12,15 @@
 #include <string>
 #include <thread>
 #include <mutex>
+#include <chrono>
 #include <enet/enet.h>
+#include "profiler.h"
+#include "batch.h"
+#include "render_queue.h"
+#include "game_logic.h"
+#include "net_message.h"
+#include "relay_buffer.h"
+#include "tick_arena.h"
 
 // Constants and enums
 namespace GameConstants {
@@ -24,43 +33,12 @@ namespace GameConstants {
     constexpr int NUM_CLOUDS = 5;
     constexpr int PORT = 1234;
     constexpr int MAX_PLAYERS = 4;
+    constexpr int RELAY_SLOTS = 1;             // Server peers kept for spectator relays
+    constexpr int SPECTATOR_PORT = 1235;
+    constexpr int MAX_SPECTATORS = 1024;       // Per relay
+    constexpr float KEYFRAME_INTERVAL = 1.0f;  // Seconds between full-state snapshots
 }
 
-enum class PowerUpType {
-    SPEED_BOOST,
-    SHIELD,
-    BALL_MAGNET,
-    GOAL_MULTIPLIER
-};
-
-enum class AIState {
-    CHASE_BALL,
-    DEFEND,
-    SUPPORT_ATTACK,
-    RETURN_TO_POSITION,
-    AVOID_OBSTACLE
-};
-
-// Network message types
-enum class MessageType {
-    PLAYER_POSITION,
-    BALL_POSITION,
-    POWERUP_SPAWN,
-    POWERUP_COLLECTED,
-    GOAL_SCORED,
-    PLAYER_JOIN,
-    PLAYER_LEAVE
-};
-
-// Network message structure
-struct NetworkMessage {
-    MessageType type;
-    int playerId;
-    float x, y, z;
-    float rotation;
-    int data;
-};
-
 // PowerUp class
 class PowerUp : public GameObject {
 private:
@@ -90,27 +68,26 @@ public:
     void render() override {
         if (!active) return;
 
-        glPushMatrix();
-        glTranslatef(x, y + sin(glutGet(GLUT_ELAPSED_TIME) / 500.0f), z);
-        glRotatef(glutGet(GLUT_ELAPSED_TIME) / 20.0f, 0, 1, 0);
+        // Queued into the shared batch; GameWorld::render() draws all power-ups in one call
+        float time = glutGet(GLUT_ELAPSED_TIME);
+        BatchTransform t = batchIdentity();
+        batchTranslate(t, x, y + sin(time / 500.0f), z);
+        batchRotate(t, time / 20.0f, 0, 1, 0);
 
         switch (type) {
             case PowerUpType::SPEED_BOOST:
-                glColor3f(1.0f, 0.5f, 0.0f);
+                batchAdd(sceneBatch(), MESH_OCTAHEDRON, t, 1.0f, 0.5f, 0.0f);
                 break;
             case PowerUpType::SHIELD:
-                glColor3f(0.0f, 1.0f, 1.0f);
+                batchAdd(sceneBatch(), MESH_OCTAHEDRON, t, 0.0f, 1.0f, 1.0f);
                 break;
             case PowerUpType::BALL_MAGNET:
-                glColor3f(1.0f, 0.0f, 1.0f);
+                batchAdd(sceneBatch(), MESH_OCTAHEDRON, t, 1.0f, 0.0f, 1.0f);
                 break;
             case PowerUpType::GOAL_MULTIPLIER:
-                glColor3f(1.0f, 1.0f, 0.0f);
+                batchAdd(sceneBatch(), MESH_OCTAHEDRON, t, 1.0f, 1.0f, 0.0f);
                 break;
         }
-
-        glutSolidOctahedron();
-        glPopMatrix();
     }
 
     bool isActive() const { return active; }
@@ -126,49 +103,44 @@ private:
     std::vector<Vec2> pathNodes;
     float decisionTimer;
 
-    struct Vec2 { float x, z; };
-    std::vector<Vec2> generatePath(Vec2 start, Vec2 end) {
-        std::vector<Vec2> path;
+    // The path lives on the tick arena; copy it into pathNodes to keep it past the tick
+    ArenaVector<Vec2> generatePath(Vec2 start, Vec2 end, TickArena& arena) {
+        ArenaVector<Vec2> path = arenaVector<Vec2>(arena, 32);
         // A* pathfinding implementation here
         return path;
     }
 
-    void updateState(const Ball& ball, const std::vector<Car*>& players) {
+    void updateState(const Ball& ball, const ArenaVector<Car*>& players, TickArena& arena) {
+        Vec2 goal{GameConstants::FIELD_RADIUS, 0};
         float ballDist = distance(controlledCar.getPosition(), ball.getPosition());
-        float goalDist = distance(controlledCar.getPosition(), Vec2{GameConstants::FIELD_RADIUS, 0});
+        float goalDist = distance(controlledCar.getPosition(), goal);
 
         // State machine logic
-        switch (currentState) {
-            case AIState::CHASE_BALL:
-                if (ballDist > 15.0f) {
-                    currentState = AIState::RETURN_TO_POSITION;
-                } else if (isTeamInDanger(players)) {
-                    currentState = AIState::DEFEND;
-                }
-                break;
-
-            case AIState::DEFEND:
-                if (!isTeamInDanger(players) && ballDist < 10.0f) {
-                    currentState = AIState::CHASE_BALL;
-                }
-                break;
+        AIState previous = currentState;
+        currentState = nextAIState(currentState, ballDist, isTeamInDanger(players));
 
-            // Add more state transitions
+        // Plan the way back to goal once, when switching to defence
+        if (currentState == AIState::DEFEND && previous != AIState::DEFEND) {
+            ArenaVector<Vec2> path = generatePath(controlledCar.getPosition(), goal, arena);
+            pathNodes.assign(path.begin(), path.end());
         }
     }
 
-    bool isTeamInDanger(const std::vector<Car*>& players) {
+    bool isTeamInDanger(const ArenaVector<Car*>& players) {
         // Analyze game situation
         return false;
     }
 
 public:
-    AIController(Car& car) : controlledCar(car), currentState(AIState::CHASE_BALL), decisionTimer(0) {}
+    AIController(Car& car) : controlledCar(car), currentState(AIState::CHASE_BALL), decisionTimer(0) {
+        pathNodes.reserve(32);
+    }
 
-    void update(float deltaTime, const Ball& ball, const std::vector<Car*>& players) {
+    // players and any path come from the tick arena and are only valid for this tick
+    void update(float deltaTime, const Ball& ball, const ArenaVector<Car*>& players, TickArena& arena) {
         decisionTimer += deltaTime;
         if (decisionTimer >= 0.5f) {
-            updateState(ball, players);
+            updateState(ball, players, arena);
             decisionTimer = 0;
         }
 
@@ -194,6 +166,11 @@ private:
     std::mutex queueMutex;
     bool isServer;
     std::map<int, ENetPeer*> clients;
+    ENetPeer* relayPeer = nullptr;
+    bool relayJoined = false;
+
+    // Messages sent this tick, packed back to back on the tick arena; NULL outside a tick
+    ArenaVector<unsigned char>* outgoing = nullptr;
 
     void handleMessage(const NetworkMessage& msg) {
         switch (msg.type) {
@@ -207,6 +184,42 @@ private:
         }
     }
 
+    // The relay takes the reserved slot; a second relay is turned away
+    void handleRelayConnect(ENetPeer* relay) {
+        if (relayPeer) {
+            enet_peer_disconnect(relay, 0);
+            return;
+        }
+        relayPeer = relay;
+        relayJoined = true;
+    }
+
+    // A packet holds one tick's messages back to back
+    void handleReceive(const ENetEvent& event) {
+        // Relays are read-only
+        if (event.peer == relayPeer) {
+            enet_packet_destroy(event.packet);
+            return;
+        }
+
+        NetworkMessage msg;
+        for (size_t offset = 0; offset + ENCODED_MESSAGE_SIZE <= event.packet->dataLength; offset += ENCODED_MESSAGE_SIZE) {
+            if (decodeMessage(event.packet->data + offset, ENCODED_MESSAGE_SIZE, msg)) {
+                handleMessage(msg);
+            }
+        }
+        enet_packet_destroy(event.packet);
+    }
+
+    void sendPacket(const unsigned char* bytes, size_t length) {
+        ENetPacket* packet = enet_packet_create(bytes, length, ENET_PACKET_FLAG_RELIABLE);
+        if (isServer) {
+            enet_host_broadcast(host, 0, packet);
+        } else {
+            enet_peer_send(peer, 0, packet);
+        }
+    }
+
 public:
     NetworkManager(bool server) : isServer(server) {
         enet_initialize();
@@ -215,39 +228,84 @@ public:
             ENetAddress address;
             address.host = ENET_HOST_ANY;
             address.port = GameConstants::PORT;
-            host = enet_host_create(&address, GameConstants::MAX_PLAYERS, 2, 0, 0);
+            host = enet_host_create(&address, GameConstants::MAX_PLAYERS + GameConstants::RELAY_SLOTS, 2, 0, 0);
         } else {
             host = enet_host_create(NULL, 1, 2, 0, 0);
         }
     }
 
     void update() {
+        PROFILE_SCOPE("network");
         ENetEvent event;
         while (enet_host_service(host, &event, 0) > 0) {
             switch (event.type) {
                 case ENET_EVENT_TYPE_CONNECT:
-                    handleConnect(event);
+                    if (isServer && event.data == RELAY_CONNECT_DATA) {
+                        handleRelayConnect(event.peer);
+                    } else if (isServer && host->connectedPeers - (relayPeer ? 1 : 0) > (size_t)GameConstants::MAX_PLAYERS) {
+                        // Only relays may use the reserved slot
+                        enet_peer_disconnect(event.peer, 0);
+                    } else {
+                        handleConnect(event);
+                    }
                     break;
                 case ENET_EVENT_TYPE_RECEIVE:
                     handleReceive(event);
                     break;
                 case ENET_EVENT_TYPE_DISCONNECT:
-                    handleDisconnect(event);
+                    if (event.peer == relayPeer) {
+                        relayPeer = nullptr;
+                    } else {
+                        handleDisconnect(event);
+                    }
                     break;
             }
         }
     }
 
+    bool isHost() const { return isServer; }
+    bool hasRelay() const { return relayPeer != nullptr; }
+
+    // True once after a relay connects, so the world can send it a keyframe straight away
+    bool takeRelayJoined() {
+        bool joined = relayJoined;
+        relayJoined = false;
+        return joined;
+    }
+
+    // Starts collecting this tick's messages on the arena
+    void beginTick(TickArena& arena) {
+        outgoing = arenaCreate<ArenaVector<unsigned char>>(arena, ArenaAllocator<unsigned char>(arena));
+        outgoing->reserve(64 * ENCODED_MESSAGE_SIZE);
+    }
+
+    // Sends everything collected since beginTick() as one packet. Call before the arena resets.
+    void flushTick() {
+        if (outgoing && !outgoing->empty()) sendPacket(outgoing->data(), outgoing->size());
+        outgoing = nullptr;
+    }
+
+    // Inside a tick the message joins the tick's packet; outside one it is sent on its own
     void sendMessage(const NetworkMessage& msg) {
-        ENetPacket* packet = enet_packet_create(&msg, sizeof(NetworkMessage),
-                                              ENET_PACKET_FLAG_RELIABLE);
-        if (isServer) {
-            enet_host_broadcast(host, 0, packet);
+        unsigned char bytes[ENCODED_MESSAGE_SIZE];
+        encodeMessage(msg, bytes);
+        if (outgoing) {
+            outgoing->insert(outgoing->end(), bytes, bytes + ENCODED_MESSAGE_SIZE);
         } else {
-            enet_peer_send(peer, 0, packet);
+            sendPacket(bytes, sizeof(bytes));
         }
     }
 
+    // Sends count messages as one packet to the relay alone; players never see it
+    void sendToRelay(const NetworkMessage* messages, size_t count) {
+        if (!relayPeer || count == 0) return;
+        ENetPacket* packet = enet_packet_create(NULL, count * ENCODED_MESSAGE_SIZE, ENET_PACKET_FLAG_RELIABLE);
+        for (size_t i = 0; i < count; i++) {
+            encodeMessage(messages[i], packet->data + i * ENCODED_MESSAGE_SIZE);
+        }
+        enet_peer_send(relayPeer, 0, packet);
+    }
+
     ~NetworkManager() {
         if (peer) enet_peer_disconnect(peer, 0);
         enet_host_destroy(host);
@@ -255,6 +313,139 @@ public:
     }
 };
 
+// Spectator relay (-relay host). Connects to a game server once, using the server's reserved
+// relay slot, and re-broadcasts its stream after RELAY_DELAY_MS to read-only spectators on
+// SPECTATOR_PORT. Each block of released messages is one packet shared by every spectator, so
+// neither the server's nor the relay's packet count grows with the audience. Spectators that
+// join late are first sent everything since the latest keyframe.
+class SpectatorRelay {
+private:
+    ENetHost* upstream;
+    ENetPeer* server;
+    ENetHost* spectators;
+    RelayBuffer buffer;
+    bool serverConnected = false;
+    const char* error = nullptr;    // Set when the constructor could not set up the relay
+
+    static long long nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void sendCatchUp(ENetPeer* spectator) {
+        if (!buffer.hasKeyframe || buffer.sinceKeyframe.empty()) return;
+        ENetPacket* packet = enet_packet_create(buffer.sinceKeyframe.data(), buffer.sinceKeyframe.size(),
+                                                ENET_PACKET_FLAG_RELIABLE);
+        enet_peer_send(spectator, 0, packet);
+    }
+
+public:
+    SpectatorRelay(const char* serverHost) : upstream(nullptr), server(nullptr), spectators(nullptr) {
+        enet_initialize();
+
+        upstream = enet_host_create(NULL, 1, 2, 0, 0);
+        if (!upstream) {
+            error = "could not create the server connection";
+            return;
+        }
+
+        ENetAddress address;
+        if (enet_address_set_host(&address, serverHost) != 0) {
+            error = "could not resolve the server address";
+            return;
+        }
+        address.port = GameConstants::PORT;
+        server = enet_host_connect(upstream, &address, 2, RELAY_CONNECT_DATA);
+        if (!server) {
+            error = "could not connect to the server";
+            return;
+        }
+
+        ENetAddress listen;
+        listen.host = ENET_HOST_ANY;
+        listen.port = GameConstants::SPECTATOR_PORT;
+        spectators = enet_host_create(&listen, GameConstants::MAX_SPECTATORS, 2, 0, 0);
+        if (!spectators) {
+            error = "could not listen for spectators";
+        }
+    }
+
+    // NULL when the relay is ready to run
+    const char* getError() const { return error; }
+
+    // Waits up to waitMs for server traffic. Returns false once the server connection is gone.
+    bool update(int waitMs) {
+        PROFILE_SCOPE("relay");
+        ENetEvent event;
+        while (enet_host_service(upstream, &event, waitMs) > 0) {
+            waitMs = 0;
+            switch (event.type) {
+                case ENET_EVENT_TYPE_CONNECT:
+                    serverConnected = true;
+                    break;
+                case ENET_EVENT_TYPE_RECEIVE:
+                    relayReceive(buffer, event.packet->data, event.packet->dataLength, nowMs());
+                    enet_packet_destroy(event.packet);
+                    break;
+                case ENET_EVENT_TYPE_DISCONNECT:
+                    return false;
+                default:
+                    break;
+            }
+        }
+
+        while (enet_host_service(spectators, &event, 0) > 0) {
+            switch (event.type) {
+                case ENET_EVENT_TYPE_CONNECT:
+                    sendCatchUp(event.peer);
+                    break;
+                case ENET_EVENT_TYPE_RECEIVE:
+                    // Spectators are read-only
+                    enet_packet_destroy(event.packet);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (relayRelease(buffer, nowMs()) > 0 && spectators->connectedPeers > 0) {
+            ENetPacket* packet = enet_packet_create(buffer.released.data(), buffer.released.size(),
+                                                    ENET_PACKET_FLAG_RELIABLE);
+            enet_host_broadcast(spectators, 0, packet);
+        }
+        enet_host_flush(spectators);
+        return true;
+    }
+
+    bool isConnected() const { return serverConnected; }
+
+    ~SpectatorRelay() {
+        if (server) enet_peer_disconnect(server, 0);
+        if (upstream) enet_host_flush(upstream);
+        if (spectators) enet_host_destroy(spectators);
+        if (upstream) enet_host_destroy(upstream);
+        enet_deinitialize();
+    }
+};
+
+// Runs the relay until the server goes away
+int runRelay(const char* serverHost) {
+    SpectatorRelay relay(serverHost);
+    if (relay.getError()) {
+        fprintf(stderr, "Relay: %s (%s)\n", relay.getError(), serverHost);
+        return 1;
+    }
+
+    while (relay.update(5)) {
+    }
+    if (!relay.isConnected()) {
+        fprintf(stderr, "Relay: could not reach server %s\n", serverHost);
+        return 1;
+    }
+    printf("Relay: server closed the match\n");
+    return 0;
+}
+
 // Enhanced Game World with scoring and power-ups
 class GameWorld {
 private:
@@ -264,6 +455,29 @@ private:
     std::map<int, int> scores;
     unsigned int fieldDisplayList;
     Ball ball;
+    RenderQueue renderQueue;
+    float keyframeTimer = 0.0f;
+    int keyframeCount = 0;
+    TickArena tickArena;
+    std::vector<AIController*> aiControllers;   // Owned by their cars
+
+    // Mesh ids for the render queue keys
+    enum WorldMesh { WORLD_FIELD, WORLD_OBJECT, WORLD_POWERUPS };
+
+    static void renderFieldItem(void* data) {
+        glCallList(static_cast<GameWorld*>(data)->fieldDisplayList);
+    }
+
+    static void renderObjectItem(void* data) {
+        static_cast<GameObject*>(data)->render();
+    }
+
+    static void renderPowerUpsItem(void* data) {
+        for (auto& powerUp : static_cast<GameWorld*>(data)->powerUps) {
+            powerUp->render();
+        }
+        batchFlush(sceneBatch());
+    }
 
     void spawnPowerUp() {
         float angle = (float)(rand() % 360) * GameConstants::PI / 180.0f;
@@ -273,11 +487,21 @@ private:
             cos(angle) * radius, sin(angle) * radius));
     }
 
+    // Every car in the world, on the tick arena
+    ArenaVector<Car*> getPlayers() {
+        ArenaVector<Car*> players = arenaVector<Car*>(tickArena, gameObjects.size());
+        for (auto& obj : gameObjects) {
+            if (Car* car = dynamic_cast<Car*>(obj.get())) players.push_back(car);
+        }
+        return players;
+    }
+
     void checkCollisions() {
+        PROFILE_SCOPE("collisions");
         for (auto& car : getPlayers()) {
             // Check power-up collisions
             for (auto& powerUp : powerUps) {
-                if (powerUp->isActive() && distance(car->getPosition(), powerUp->getPosition()) < 1.5f) {
+                if (powerUp->isActive() && inPickupRange(car->getPosition(), powerUp->getPosition(), 1.5f)) {
                     applyPowerUp(*car, powerUp->getType());
                     powerUp->collect();
                     // Send network message
@@ -287,12 +511,29 @@ private:
             }
 
             // Check ball collision
-            if (distance(car->getPosition(), ball.getPosition()) < 2.0f) {
+            if (inPickupRange(car->getPosition(), ball.getPosition(), 2.0f)) {
                 handleBallCollision(*car);
             }
         }
     }
 
+    // Full-state snapshot for the relay: a KEYFRAME marker, then every object and the ball
+    void sendKeyframe() {
+        ArenaVector<NetworkMessage> keyframe = arenaVector<NetworkMessage>(tickArena, gameObjects.size() + 2);
+        NetworkMessage marker{MessageType::KEYFRAME};
+        marker.data = keyframeCount++;
+        keyframe.push_back(marker);
+
+        for (size_t i = 0; i < gameObjects.size(); i++) {
+            Vec2 position = gameObjects[i]->getPosition();
+            keyframe.push_back(NetworkMessage{MessageType::PLAYER_POSITION, (int)i, position.x, 0.0f, position.z});
+        }
+
+        Vec2 ballPosition = ball.getPosition();
+        keyframe.push_back(NetworkMessage{MessageType::BALL_POSITION, -1, ballPosition.x, 0.0f, ballPosition.z});
+        network->sendToRelay(keyframe.data(), keyframe.size());
+    }
+
     void applyPowerUp(Car& car, PowerUpType type) {
         switch (type) {
             case PowerUpType::SPEED_BOOST:
@@ -318,18 +559,28 @@ public:
         gameObjects.push_back(std::make_unique<Car>(false)); // Player
         for (int i = 0; i < 2; ++i) {
             auto aiCar = std::make_unique<Car>(true);
-            aiCar->setAIController(std::make_unique<AIController>(*aiCar));
+            auto ai = std::make_unique<AIController>(*aiCar);
+            aiControllers.push_back(ai.get());
+            aiCar->setAIController(std::move(ai));
             gameObjects.push_back(std::move(aiCar));
         }
     }
 
     void update(float deltaTime) {
+        PROFILE_SCOPE("world update");
+        TickScope tick(tickArena);
         network->update();
+        network->beginTick(tickArena);
 
         for (auto& obj : gameObjects) {
             obj->update(deltaTime);
         }
 
+        ArenaVector<Car*> players = getPlayers();
+        for (AIController* ai : aiControllers) {
+            ai->update(deltaTime, ball, players, tickArena);
+        }
+
         for (auto& powerUp : powerUps) {
             powerUp->update(deltaTime);
         }
@@ -337,30 +588,53 @@ public:
         checkCollisions();
         checkScoring();
 
+        // Only a relay needs keyframes; players already get every update
+        if (network->hasRelay()) {
+            keyframeTimer -= deltaTime;
+            if (network->takeRelayJoined() || keyframeTimer <= 0.0f) {
+                sendKeyframe();
+                keyframeTimer = GameConstants::KEYFRAME_INTERVAL;
+            }
+        }
+
         // Spawn new power-ups occasionally
         if (rand() % 300 == 0) {
             spawnPowerUp();
         }
+
+        network->flushTick();
     }
 
     void render() {
-        glCallList(fieldDisplayList);
+        PROFILE_SCOPE("world render");
+        renderQueueBegin(renderQueue);
+        renderQueueAdd(renderQueue, PASS_OPAQUE, MATERIAL_LIT, WORLD_FIELD, 0.0f, 0.0f, 0.0f, renderFieldItem, this);
 
         for (auto& obj : gameObjects) {
-            obj->render();
+            Vec2 position = obj->getPosition();
+            renderQueueAdd(renderQueue, PASS_OPAQUE, MATERIAL_LIT, WORLD_OBJECT, position.x, 0.0f, position.z,
+                           renderObjectItem, obj.get());
         }
 
-        for (auto& powerUp : powerUps) {
-            powerUp->render();
-        }
+        // Power-ups are batched into one draw
+        renderQueueAdd(renderQueue, PASS_OPAQUE, MATERIAL_LIT, WORLD_POWERUPS, 0.0f, 1.0f, 0.0f, renderPowerUpsItem, this);
+        renderQueueFlush(renderQueue);
 
         renderScoreboard();
+        profilerDrawOverlay(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
     }
 };
 
+TICK_ALLOCATION_TRACKING
+
 // Main game loop remains largely the same, but now includes network initialization
 
 int main(int argc, char** argv) {
+    // Relay mode runs headless
+    if (argc > 2 && strcmp(argv[1], "-relay") == 0) {
+        return runRelay(argv[2]);
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
     glutInitWindowSize(800, 600);
@@ -0,0 +1,88 @@
+#ifndef NET_MESSAGE_H
+#define NET_MESSAGE_H
+
+// Network messages and their wire format
+
+#include <stdint.h>
+#include <string.h>
+
+// Network message types
+enum class MessageType {
+    PLAYER_POSITION,
+    BALL_POSITION,
+    POWERUP_SPAWN,
+    POWERUP_COLLECTED,
+    GOAL_SCORED,
+    PLAYER_JOIN,
+    PLAYER_LEAVE,
+    KEYFRAME            // Starts a full-state snapshot; data holds the keyframe number
+};
+
+const int MESSAGE_TYPE_COUNT = 8;
+
+// Connect data (enet_host_connect) a spectator relay uses to claim the server's relay slot
+const uint32_t RELAY_CONNECT_DATA = 0x52454c59;
+
+// Network message structure
+struct NetworkMessage {
+    MessageType type;
+    int playerId;
+    float x, y, z;
+    float rotation;
+    int data;
+};
+
+// Encoded size: type (1) + player id (2) + x, y, z, rotation (4 x 4) + data (4)
+const int ENCODED_MESSAGE_SIZE = 23;
+
+inline void writeU32(unsigned char* out, uint32_t value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    out[2] = (unsigned char)(value >> 16);
+    out[3] = (unsigned char)(value >> 24);
+}
+
+inline uint32_t readU32(const unsigned char* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+inline void writeFloat(unsigned char* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeU32(out, bits);
+}
+
+inline float readFloat(const unsigned char* in) {
+    uint32_t bits = readU32(in);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Packs a message little-endian into ENCODED_MESSAGE_SIZE bytes, independent of struct padding and host byte order
+inline void encodeMessage(const NetworkMessage& msg, unsigned char* out) {
+    out[0] = (unsigned char)msg.type;
+    out[1] = (unsigned char)msg.playerId;
+    out[2] = (unsigned char)(msg.playerId >> 8);
+    writeFloat(out + 3, msg.x);
+    writeFloat(out + 7, msg.y);
+    writeFloat(out + 11, msg.z);
+    writeFloat(out + 15, msg.rotation);
+    writeU32(out + 19, (uint32_t)msg.data);
+}
+
+// Returns false if the bytes are not a valid message
+inline bool decodeMessage(const unsigned char* in, size_t length, NetworkMessage& msg) {
+    if (length < (size_t)ENCODED_MESSAGE_SIZE || in[0] >= MESSAGE_TYPE_COUNT) return false;
+
+    msg.type = (MessageType)in[0];
+    msg.playerId = (int16_t)(in[1] | (in[2] << 8));
+    msg.x = readFloat(in + 3);
+    msg.y = readFloat(in + 7);
+    msg.z = readFloat(in + 11);
+    msg.rotation = readFloat(in + 15);
+    msg.data = (int)readU32(in + 19);
+    return true;
+}
+
+#endif
@@ -0,0 +1,341 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Frame and tick profiler.
+//
+// Compile with -DENABLE_PROFILER to turn the PROFILE_SCOPE / PROFILE_DRAW markers on.
+// Without it they expand to nothing, so instrumented hot paths cost nothing in release, and
+// the overlay, which would only show empty rows, draws nothing.
+//
+//   PROFILE_SCOPE("update");      // Times the enclosing block under the "update" zone
+//   PROFILE_DRAW(24);             // Counts one GL draw call submitting 24 vertices
+//
+// Call profilerNewFrame() once per displayed frame. The overlay shows a rolling
+// per-zone breakdown, and profilerStartTrace()/profilerStopTrace() write a
+// Chrome trace (chrome://tracing or ui.perfetto.dev).
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/glut.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+const int PROFILER_MAX_ZONES = 32;
+const int PROFILER_HISTORY = 120;              // Frames kept for the rolling averages
+const size_t PROFILER_MAX_TRACE_EVENTS = 1 << 20;
+
+// One named subsystem (e.g. "display", "update")
+struct ProfilerZone {
+    const char* name;
+    std::atomic<long long> frameNs;            // Time spent in the zone during the current frame
+    float historyMs[PROFILER_HISTORY];         // Per-frame totals of previous frames
+};
+
+// A single timed scope, recorded while a trace capture is running
+struct TraceEvent {
+    int zone;
+    int thread;
+    long long startNs;
+    long long durationNs;
+};
+
+struct Profiler {
+    ProfilerZone zones[PROFILER_MAX_ZONES];
+    std::atomic<int> zoneCount{0};
+    std::mutex zoneMutex;
+
+    // Frame timing and per-frame GL counters
+    long long frameStartNs = 0;
+    float frameMs[PROFILER_HISTORY] = {};
+    int historyIndex = 0;
+    int framesRecorded = 0;
+    std::atomic<int> drawCalls{0};
+    std::atomic<int> stateChanges{0};
+    std::atomic<long long> vertices{0};
+    int lastDrawCalls = 0;
+    int lastStateChanges = 0;
+    long long lastVertices = 0;
+
+    // Input-to-present latency samples, traced under latencyZone
+    int latencyZone = -1;
+    float latencyMs[PROFILER_HISTORY] = {};
+    int latencyIndex = 0;
+    int latencyCount = 0;
+
+    // Chrome trace capture
+    std::atomic<bool> capturing{false};
+    std::mutex traceMutex;
+    std::vector<TraceEvent> trace;
+
+    bool overlayVisible = false;
+};
+
+inline Profiler& profiler() {
+    static Profiler instance;
+    return instance;
+}
+
+// Nanoseconds on the monotonic clock (the same clock as inputClockNs() in input.h)
+inline long long profilerNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Small stable id for the calling thread, used as the trace "tid"
+inline int profilerThreadId() {
+    static std::atomic<int> nextId{0};
+    thread_local int id = nextId++;
+    return id;
+}
+
+// Returns the index of the zone with this name, creating it on first use
+inline int profilerZone(const char* name) {
+    Profiler& p = profiler();
+    std::lock_guard<std::mutex> lock(p.zoneMutex);
+    for (int i = 0; i < p.zoneCount; i++) {
+        if (strcmp(p.zones[i].name, name) == 0) return i;
+    }
+    if (p.zoneCount == PROFILER_MAX_ZONES) return PROFILER_MAX_ZONES - 1;
+
+    ProfilerZone& zone = p.zones[p.zoneCount];
+    zone.name = name;
+    zone.frameNs = 0;
+    for (int i = 0; i < PROFILER_HISTORY; i++) zone.historyMs[i] = 0.0f;
+    return p.zoneCount++;
+}
+
+inline void profilerRecord(int zone, long long startNs, long long endNs) {
+    Profiler& p = profiler();
+    p.zones[zone].frameNs.fetch_add(endNs - startNs, std::memory_order_relaxed);
+
+    if (p.capturing.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(p.traceMutex);
+        if (p.trace.size() < PROFILER_MAX_TRACE_EVENTS) {
+            p.trace.push_back({zone, profilerThreadId(), startNs, endNs - startNs});
+        }
+    }
+}
+
+// Records the time from an input event to the frame that first showed its effect
+inline void profilerRecordLatency(long long inputNs, long long presentNs) {
+    static const int zone = profilerZone("input latency");
+    Profiler& p = profiler();
+    p.latencyZone = zone;
+    p.latencyMs[p.latencyIndex] = (presentNs - inputNs) / 1.0e6f;
+    p.latencyIndex = (p.latencyIndex + 1) % PROFILER_HISTORY;
+    if (p.latencyCount < PROFILER_HISTORY) p.latencyCount++;
+
+    if (p.capturing.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(p.traceMutex);
+        if (p.trace.size() < PROFILER_MAX_TRACE_EVENTS) {
+            p.trace.push_back({zone, profilerThreadId(), inputNs, presentNs - inputNs});
+        }
+    }
+}
+
+inline void profilerCountStateChanges(int count) {
+    profiler().stateChanges.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void profilerCountDraw(int vertexCount) {
+    Profiler& p = profiler();
+    p.drawCalls.fetch_add(1, std::memory_order_relaxed);
+    p.vertices.fetch_add(vertexCount, std::memory_order_relaxed);
+}
+
+// Times the scope it lives in
+class ProfileScope {
+private:
+    int zone;
+    long long start;
+
+public:
+    explicit ProfileScope(int z) : zone(z), start(profilerNow()) {}
+    ~ProfileScope() { profilerRecord(zone, start, profilerNow()); }
+};
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_SCOPE(name) \
+    static const int PROFILER_CONCAT(profileZone_, __LINE__) = profilerZone(name); \
+    ProfileScope PROFILER_CONCAT(profileScope_, __LINE__)(PROFILER_CONCAT(profileZone_, __LINE__))
+#define PROFILE_DRAW(vertexCount) profilerCountDraw(vertexCount)
+#define PROFILE_STATE_CHANGES(count) profilerCountStateChanges(count)
+#define PROFILE_LATENCY(inputNs, presentNs) profilerRecordLatency(inputNs, presentNs)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_DRAW(vertexCount) ((void)0)
+#define PROFILE_STATE_CHANGES(count) ((void)0)
+#define PROFILE_LATENCY(inputNs, presentNs) ((void)0)
+#endif
+
+// Closes the current frame: rolls zone times and GL counters into the history
+inline void profilerNewFrame() {
+    Profiler& p = profiler();
+    long long now = profilerNow();
+
+    if (p.frameStartNs != 0) {
+        p.frameMs[p.historyIndex] = (now - p.frameStartNs) / 1.0e6f;
+        for (int i = 0; i < p.zoneCount; i++) {
+            p.zones[i].historyMs[p.historyIndex] = p.zones[i].frameNs.exchange(0) / 1.0e6f;
+        }
+        p.historyIndex = (p.historyIndex + 1) % PROFILER_HISTORY;
+        if (p.framesRecorded < PROFILER_HISTORY) p.framesRecorded++;
+    }
+
+    p.lastDrawCalls = p.drawCalls.exchange(0);
+    p.lastStateChanges = p.stateChanges.exchange(0);
+    p.lastVertices = p.vertices.exchange(0);
+    p.frameStartNs = now;
+}
+
+// Average and worst value of a rolling history
+inline void profilerStats(const float* history, int count, float& avg, float& max) {
+    avg = 0.0f;
+    max = 0.0f;
+    for (int i = 0; i < count; i++) {
+        avg += history[i];
+        if (history[i] > max) max = history[i];
+    }
+    if (count > 0) avg /= count;
+}
+
+inline void profilerStartTrace() {
+    Profiler& p = profiler();
+    std::lock_guard<std::mutex> lock(p.traceMutex);
+    p.trace.clear();
+    p.trace.reserve(65536);
+    p.capturing = true;
+}
+
+// Stops capturing and writes the events as Chrome trace JSON. Returns false if the file can't be written.
+inline bool profilerStopTrace(const char* path) {
+    Profiler& p = profiler();
+    p.capturing = false;
+
+    std::lock_guard<std::mutex> lock(p.traceMutex);
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    // Timestamps are written relative to the earliest event
+    long long base = p.trace.empty() ? 0 : p.trace[0].startNs;
+    for (size_t i = 0; i < p.trace.size(); i++) {
+        if (p.trace[i].startNs < base) base = p.trace[i].startNs;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < p.trace.size(); i++) {
+        const TraceEvent& e = p.trace[i];
+        fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                p.zones[e.zone].name, e.thread, (e.startNs - base) / 1000.0, e.durationNs / 1000.0,
+                i + 1 < p.trace.size() ? "," : "");
+    }
+    fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+
+    p.trace.clear();
+    p.trace.shrink_to_fit();
+    return true;
+}
+
+inline void profilerDrawText(float x, float y, const char* text) {
+    glRasterPos2f(x, y);
+    for (const char* c = text; *c; c++) {
+        glutBitmapCharacter(GLUT_BITMAP_8_BY_13, *c);
+    }
+}
+
+#ifdef ENABLE_PROFILER
+// Draws the frame-time breakdown in the top-left corner of a w x h window
+inline void profilerDrawOverlay(int w, int h) {
+    Profiler& p = profiler();
+    if (!p.overlayVisible) return;
+
+    const float lineHeight = 15.0f;
+    const float barScale = 200.0f / 16.6f;   // 200 px per 60 FPS frame budget
+    char line[128];
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, w, 0, h);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    float top = h - 10.0f;
+    float bottom = top - lineHeight * (p.zoneCount + 3) - 5.0f;
+
+    // Backdrop
+    glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+    glBegin(GL_QUADS);
+    glVertex2f(5.0f, bottom);
+    glVertex2f(480.0f, bottom);
+    glVertex2f(480.0f, top + 5.0f);
+    glVertex2f(5.0f, top + 5.0f);
+    glEnd();
+
+    float avg, max;
+    float y = top - lineHeight + 3.0f;
+    profilerStats(p.frameMs, p.framesRecorded, avg, max);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    snprintf(line, sizeof(line), "frame   avg %6.2f ms  max %6.2f ms  (%.0f FPS)",
+             avg, max, avg > 0.0f ? 1000.0f / avg : 0.0f);
+    profilerDrawText(10.0f, y, line);
+
+    for (int i = 0; i < p.zoneCount; i++) {
+        if (i == p.latencyZone) continue;
+        y -= lineHeight;
+        profilerStats(p.zones[i].historyMs, p.framesRecorded, avg, max);
+
+        // Bar showing the zone's share of the frame budget
+        glColor3f(0.2f, 0.8f, 0.2f);
+        glBegin(GL_QUADS);
+        glVertex2f(270.0f, y - 2.0f);
+        glVertex2f(270.0f + avg * barScale, y - 2.0f);
+        glVertex2f(270.0f + avg * barScale, y + 9.0f);
+        glVertex2f(270.0f, y + 9.0f);
+        glEnd();
+
+        glColor3f(1.0f, 1.0f, 1.0f);
+        snprintf(line, sizeof(line), "%-14.14s %6.2f / %6.2f", p.zones[i].name, avg, max);
+        profilerDrawText(10.0f, y, line);
+    }
+
+    if (p.latencyCount > 0) {
+        y -= lineHeight;
+        profilerStats(p.latencyMs, p.latencyCount, avg, max);
+        snprintf(line, sizeof(line), "input latency  %6.2f / %6.2f", avg, max);
+        profilerDrawText(10.0f, y, line);
+    }
+
+    y -= lineHeight;
+    snprintf(line, sizeof(line), "draw calls %d  vertices %lld  state changes %d%s",
+             p.lastDrawCalls, p.lastVertices, p.lastStateChanges, p.capturing ? "  [tracing]" : "");
+    profilerDrawText(10.0f, y, line);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
+#else
+inline void profilerDrawOverlay(int, int) {}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef RELAY_BUFFER_H
+#define RELAY_BUFFER_H
+
+// Delay buffer for the spectator relay (main.cpp, -relay mode).
+//
+// Messages from the game server are held back for RELAY_DELAY_MS before spectators see them.
+// Each relay update then releases the due messages as one block of back-to-back encoded
+// messages, which goes out to every spectator as a single shared packet. Everything released
+// since the latest keyframe is also kept, so a spectator who joins mid-match can be sent one
+// catch-up block that starts at that keyframe. ENet-free so the same code can be benchmarked.
+
+#include <deque>
+#include <vector>
+#include "net_message.h"
+
+const long long RELAY_DELAY_MS = 2000;
+
+struct RelayEntry {
+    long long releaseMs;
+    unsigned char bytes[ENCODED_MESSAGE_SIZE];
+};
+
+struct RelayBuffer {
+    std::deque<RelayEntry> pending;             // Received but still inside the delay
+    std::vector<unsigned char> released;        // Messages released by the last relayRelease()
+    std::vector<unsigned char> sinceKeyframe;   // Latest released keyframe and everything after it
+    bool hasKeyframe = false;
+};
+
+// Splits a packet from the server into messages and queues the valid ones. Returns the number queued.
+inline int relayReceive(RelayBuffer& buffer, const unsigned char* data, size_t length, long long nowMs) {
+    int queued = 0;
+    NetworkMessage msg;
+    for (size_t offset = 0; offset + ENCODED_MESSAGE_SIZE <= length; offset += ENCODED_MESSAGE_SIZE) {
+        if (!decodeMessage(data + offset, ENCODED_MESSAGE_SIZE, msg)) continue;
+
+        RelayEntry entry;
+        entry.releaseMs = nowMs + RELAY_DELAY_MS;
+        memcpy(entry.bytes, data + offset, ENCODED_MESSAGE_SIZE);
+        buffer.pending.push_back(entry);
+        queued++;
+    }
+    return queued;
+}
+
+// Moves every message whose delay has passed into buffer.released. Returns its size in bytes.
+inline size_t relayRelease(RelayBuffer& buffer, long long nowMs) {
+    buffer.released.clear();
+    while (!buffer.pending.empty() && buffer.pending.front().releaseMs <= nowMs) {
+        const unsigned char* bytes = buffer.pending.front().bytes;
+        if (bytes[0] == (unsigned char)MessageType::KEYFRAME) {
+            buffer.sinceKeyframe.clear();
+            buffer.hasKeyframe = true;
+        }
+
+        buffer.released.insert(buffer.released.end(), bytes, bytes + ENCODED_MESSAGE_SIZE);
+        if (buffer.hasKeyframe) {
+            buffer.sinceKeyframe.insert(buffer.sinceKeyframe.end(), bytes, bytes + ENCODED_MESSAGE_SIZE);
+        }
+        buffer.pending.pop_front();
+    }
+    return buffer.released.size();
+}
+
+#endif
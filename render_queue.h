@@ -0,0 +1,295 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+// Sorted render queue.
+//
+// Instead of drawing straight away, a frame adds one item per draw: a callback, a material
+// and the position it is drawn at. renderQueueFlush() sorts the items by a packed 64-bit key
+// and runs them in that order. Opaque items are grouped by material and mesh, then sorted
+// front to back so the depth test rejects hidden pixels early. Translucent items are sorted
+// back to front so blending composes correctly. A material's GL state is only changed when
+// it differs from the state already set, and the number of changes goes to the profiler.
+//
+// One queue can feed up to RENDER_MAX_VIEWS cameras (split-screen). Each item is tested
+// against every view's frustum once, when it is added, and the opaque items are sorted once
+// for all views. renderQueueFlushView() then replays the shared list into one view, skipping
+// items that view can't see and re-sorting only the translucent items for its camera.
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include <GL/gl.h>
+#include "profiler.h"
+
+enum RenderPass {
+    PASS_OPAQUE,
+    PASS_TRANSLUCENT
+};
+
+enum RenderMaterial {
+    MATERIAL_COLOR,         // Flat vertex colors, no lighting
+    MATERIAL_LIT,           // Vertex colors with GL lighting
+    MATERIAL_SPRITE,        // Alpha-blended texture, no depth writes (clouds)
+    MATERIAL_COUNT
+};
+
+// Fixed-function state each material needs
+struct MaterialState {
+    bool lighting;
+    bool blend;
+    bool texture;
+    bool depthWrite;
+};
+
+const MaterialState materialStates[MATERIAL_COUNT] = {
+    {false, false, false, true},
+    {true, false, false, true},
+    {false, true, true, false}
+};
+
+const float RENDER_QUEUE_FAR = 1000.0f;     // View depth mapped onto the 24 key bits
+const int RENDER_MAX_VIEWS = 4;
+const float RENDER_UNBOUNDED = -1.0f;       // Bounding radius of items drawn in every view
+
+// One camera the queue is drawn for
+struct RenderView {
+    float view[16];                     // Camera transform
+    float planes[6][4];                 // World-space frustum planes, normals pointing inwards
+};
+
+struct RenderItem {
+    uint64_t key;
+    RenderMaterial material;
+    void (*draw)(void* data);
+    void* data;
+    float x, y, z;                      // Where it is drawn, to re-sort translucent items per view
+    unsigned int viewMask;              // Bit v is set if view v can see the item
+};
+
+struct RenderQueue {
+    std::vector<RenderItem> items;      // Keeps its capacity from frame to frame
+    std::vector<RenderItem> viewItems;  // One view's translucent items, re-sorted for its camera
+    RenderView views[RENDER_MAX_VIEWS];
+    int viewCount = 0;
+    unsigned int sequence = 0;
+    bool sorted = false;
+};
+
+// Starts a new frame with no views; add each camera with renderQueueAddView()
+inline void renderQueueBeginViews(RenderQueue& queue) {
+    queue.items.clear();
+    queue.viewCount = 0;
+    queue.sequence = 0;
+    queue.sorted = false;
+}
+
+// Captures the current projection and modelview as the next view and returns its index,
+// or -1 if there are already RENDER_MAX_VIEWS. Expects the modelview matrix to hold only
+// the camera transform. Add every view before the items.
+inline int renderQueueAddView(RenderQueue& queue) {
+    if (queue.viewCount == RENDER_MAX_VIEWS) return -1;
+    RenderView& view = queue.views[queue.viewCount];
+
+    float projection[16], clip[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, view.view);
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            clip[col * 4 + row] = projection[row] * view.view[col * 4] + projection[4 + row] * view.view[col * 4 + 1] +
+                                  projection[8 + row] * view.view[col * 4 + 2] + projection[12 + row] * view.view[col * 4 + 3];
+        }
+    }
+
+    // Left, right, bottom, top, near and far planes: the fourth row of the clip matrix plus or
+    // minus each of the other three
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        float* plane = view.planes[i];
+        for (int col = 0; col < 4; col++) plane[col] = clip[col * 4 + 3] + sign * clip[col * 4 + row];
+
+        float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        for (int col = 0; col < 4; col++) plane[col] /= length;
+    }
+    return queue.viewCount++;
+}
+
+// Starts a new frame for the single current camera
+inline void renderQueueBegin(RenderQueue& queue) {
+    renderQueueBeginViews(queue);
+    renderQueueAddView(queue);
+}
+
+inline float renderViewDepth(const RenderView& view, float x, float y, float z) {
+    const float* m = view.view;
+    return -(m[2] * x + m[6] * y + m[10] * z + m[14]);
+}
+
+inline bool renderViewSees(const RenderView& view, float x, float y, float z, float radius) {
+    if (radius < 0.0f) return true;
+    for (int i = 0; i < 6; i++) {
+        const float* plane = view.planes[i];
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < -radius) return false;
+    }
+    return true;
+}
+
+// Splits a w x h window into count viewports (1 full, 2 stacked, 3-4 in quadrants)
+inline void renderSplitViewport(int index, int count, int w, int h, int& x, int& y, int& vw, int& vh) {
+    if (count <= 1) {
+        x = y = 0;
+        vw = w;
+        vh = h;
+    } else if (count == 2) {
+        x = 0;
+        vw = w;
+        vh = h / 2;
+        y = index == 0 ? h - vh : 0;
+    } else {
+        vw = w / 2;
+        vh = h / 2;
+        x = (index % 2) * vw;
+        y = index < 2 ? h - vh : 0;
+    }
+}
+
+// Key layout, most significant bits first:
+//   opaque:      pass (2) | material (6) | mesh (8) | depth (24) | sequence (24)
+//   translucent: pass (2) | far-to-near depth (24) | material (6) | mesh (8) | sequence (24)
+// The sequence number keeps items with equal keys in the order they were added.
+inline uint64_t renderSortKey(RenderPass pass, RenderMaterial material, int mesh, float depth, unsigned int sequence) {
+    float scaled = depth / RENDER_QUEUE_FAR;
+    if (scaled < 0.0f) scaled = 0.0f;
+    if (scaled > 1.0f) scaled = 1.0f;
+    uint64_t depthBits = (uint64_t)(scaled * 0xFFFFFF);
+
+    uint64_t key = (uint64_t)pass << 62;
+    if (pass == PASS_OPAQUE) {
+        key |= (uint64_t)(material & 0x3F) << 56;
+        key |= (uint64_t)(mesh & 0xFF) << 48;
+        key |= depthBits << 24;
+    } else {
+        key |= (0xFFFFFF - depthBits) << 38;
+        key |= (uint64_t)(material & 0x3F) << 32;
+        key |= (uint64_t)(mesh & 0xFF) << 24;
+    }
+    return key | (sequence & 0xFFFFFF);
+}
+
+// Adds a draw whose geometry fits in a sphere of the given radius around world position
+// (x, y, z). Views that can't see the sphere skip it, and an item no view sees is dropped.
+// Opaque items sort on their nearest depth over the views. The mesh id only groups items
+// that draw the same geometry, so any small number the caller picks will do.
+inline void renderQueueAddBounded(RenderQueue& queue, RenderPass pass, RenderMaterial material, int mesh,
+                                  float x, float y, float z, float radius, void (*draw)(void*), void* data) {
+    unsigned int viewMask = 0;
+    float depth = RENDER_QUEUE_FAR;
+    for (int v = 0; v < queue.viewCount; v++) {
+        if (!renderViewSees(queue.views[v], x, y, z, radius)) continue;
+        viewMask |= 1u << v;
+        float viewDepth = renderViewDepth(queue.views[v], x, y, z);
+        if (viewDepth < depth) depth = viewDepth;
+    }
+    if (viewMask == 0) return;
+
+    RenderItem item = {renderSortKey(pass, material, mesh, depth, queue.sequence++), material, draw, data,
+                       x, y, z, viewMask};
+    queue.items.push_back(item);
+}
+
+// Adds a draw at world position (x, y, z) that every view draws
+inline void renderQueueAdd(RenderQueue& queue, RenderPass pass, RenderMaterial material, int mesh,
+                           float x, float y, float z, void (*draw)(void*), void* data) {
+    renderQueueAddBounded(queue, pass, material, mesh, x, y, z, RENDER_UNBOUNDED, draw, data);
+}
+
+// Sets one capability if it differs from the tracked value; returns the number of GL calls made
+inline int renderSetCapability(GLenum capability, bool enable, bool& current) {
+    if (enable == current) return 0;
+    if (enable) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+    current = enable;
+    return 1;
+}
+
+inline int renderApplyState(const MaterialState& wanted, MaterialState& current) {
+    int changes = renderSetCapability(GL_LIGHTING, wanted.lighting, current.lighting);
+    if (wanted.blend && !current.blend) {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        changes++;
+    }
+    changes += renderSetCapability(GL_BLEND, wanted.blend, current.blend);
+    changes += renderSetCapability(GL_TEXTURE_2D, wanted.texture, current.texture);
+    if (wanted.depthWrite != current.depthWrite) {
+        glDepthMask(wanted.depthWrite ? GL_TRUE : GL_FALSE);
+        current.depthWrite = wanted.depthWrite;
+        changes++;
+    }
+    return changes;
+}
+
+inline bool renderItemBefore(const RenderItem& a, const RenderItem& b) {
+    return a.key < b.key;
+}
+
+// Draws the items one view can see, then restores the state it found. Expects the viewport and
+// the view's camera to be set, since the draw callbacks use the current matrices. The items are
+// sorted on the first call after they were added; translucent ones are re-sorted for each view.
+// Returns the number of state changes made.
+inline int renderQueueFlushView(RenderQueue& queue, int viewIndex) {
+    if (!queue.sorted) {
+        std::sort(queue.items.begin(), queue.items.end(), renderItemBefore);
+        queue.sorted = true;
+    }
+
+    GLboolean depthWrite;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthWrite);
+    MaterialState initial = {glIsEnabled(GL_LIGHTING) == GL_TRUE, glIsEnabled(GL_BLEND) == GL_TRUE,
+                             glIsEnabled(GL_TEXTURE_2D) == GL_TRUE, depthWrite == GL_TRUE};
+    MaterialState current = initial;
+
+    unsigned int bit = 1u << viewIndex;
+    const RenderView& view = queue.views[viewIndex];
+    queue.viewItems.clear();
+
+    int changes = 0;
+    for (size_t i = 0; i < queue.items.size(); i++) {
+        const RenderItem& item = queue.items[i];
+        if (!(item.viewMask & bit)) continue;
+
+        if (item.key >> 62 == PASS_TRANSLUCENT) {
+            RenderItem viewItem = item;
+            viewItem.key = renderSortKey(PASS_TRANSLUCENT, item.material, (int)(item.key >> 24) & 0xFF,
+                                         renderViewDepth(view, item.x, item.y, item.z), (unsigned int)item.key);
+            queue.viewItems.push_back(viewItem);
+            continue;
+        }
+        changes += renderApplyState(materialStates[item.material], current);
+        item.draw(item.data);
+    }
+
+    std::sort(queue.viewItems.begin(), queue.viewItems.end(), renderItemBefore);
+    for (size_t i = 0; i < queue.viewItems.size(); i++) {
+        const RenderItem& item = queue.viewItems[i];
+        changes += renderApplyState(materialStates[item.material], current);
+        item.draw(item.data);
+    }
+    changes += renderApplyState(initial, current);
+
+    PROFILE_STATE_CHANGES(changes);
+    return changes;
+}
+
+// Draws every item for the single view of renderQueueBegin()
+inline int renderQueueFlush(RenderQueue& queue) {
+    return renderQueueFlushView(queue, 0);
+}
+
+#endif
@@ -0,0 +1,558 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+// Drawing code for the stadium, cars and clouds, shared by Two-cars.cpp and the render benchmark.
+// The primitives below only use GL/GLU, so the scene can also be drawn into an offscreen
+// context where GLUT was never initialised.
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <math.h>
+#include <stdlib.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include "profiler.h"
+#include "simulation.h"
+#include "batch.h"
+
+// Mesh ids for render queue keys, so items drawing the same geometry sort together
+enum SceneMesh {
+    SCENE_FIELD,
+    SCENE_GOAL,
+    SCENE_SEATS,
+    SCENE_STANDS,
+    SCENE_BALL,
+    SCENE_CARS,
+    SCENE_SKY
+};
+
+// Quadric shared by every cylinder and sphere
+inline GLUquadric* sceneQuadric() {
+    static GLUquadric* quad = gluNewQuadric();
+    return quad;
+}
+
+// Unit-sized cube centred on the origin (replacement for glutSolidCube)
+inline void solidCube(float size) {
+    static const float normals[6][3] = {
+        {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+    };
+    static const float corners[6][4][3] = {
+        {{1, -1, -1}, {1, 1, -1}, {1, 1, 1}, {1, -1, 1}},
+        {{-1, -1, 1}, {-1, 1, 1}, {-1, 1, -1}, {-1, -1, -1}},
+        {{-1, 1, -1}, {-1, 1, 1}, {1, 1, 1}, {1, 1, -1}},
+        {{-1, -1, -1}, {1, -1, -1}, {1, -1, 1}, {-1, -1, 1}},
+        {{-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}},
+        {{-1, -1, -1}, {-1, 1, -1}, {1, 1, -1}, {1, -1, -1}}
+    };
+    float h = size * 0.5f;
+
+    glBegin(GL_QUADS);
+    for (int face = 0; face < 6; face++) {
+        glNormal3fv(normals[face]);
+        for (int i = 0; i < 4; i++) {
+            glVertex3f(corners[face][i][0] * h, corners[face][i][1] * h, corners[face][i][2] * h);
+        }
+    }
+    glEnd();
+    PROFILE_DRAW(24);
+}
+
+inline void solidSphere(float radius, int slices, int stacks) {
+    gluSphere(sceneQuadric(), radius, slices, stacks);
+    PROFILE_DRAW(stacks * (slices + 1) * 2);
+}
+
+// Torus around the Z axis, same parameters as glutSolidTorus
+inline void solidTorus(float innerRadius, float outerRadius, int sides, int rings) {
+    const float twoPi = 6.2831853f;
+
+    glBegin(GL_QUADS);
+    for (int i = 0; i < rings; i++) {
+        for (int j = 0; j < sides; j++) {
+            for (int k = 0; k < 4; k++) {
+                int ring = i + (k == 1 || k == 2);
+                int side = j + (k >= 2);
+                float u = ring * twoPi / rings;
+                float v = side * twoPi / sides;
+                float nx = cosf(u) * cosf(v), ny = sinf(u) * cosf(v), nz = sinf(v);
+                glNormal3f(nx, ny, nz);
+                glVertex3f(cosf(u) * outerRadius + nx * innerRadius,
+                           sinf(u) * outerRadius + ny * innerRadius,
+                           nz * innerRadius);
+            }
+        }
+    }
+    glEnd();
+    PROFILE_DRAW(rings * sides * 4);
+}
+
+inline void drawCylinder(float radius, float height, int slices, int stacks) {
+    gluCylinder(sceneQuadric(), radius, radius, height, slices, stacks);
+    PROFILE_DRAW(stacks * (slices + 1) * 2);
+}
+
+inline void drawHollowPipe(float outerRadius, float height) {
+    glPushMatrix();
+    glColor3f(1.0f, 1.0f, 1.0f);
+    drawCylinder(outerRadius, height, 10, 10);
+    glPopMatrix();
+}
+
+inline void drawField() {
+    glColor3f(0.0, 0.8, 0.0);
+
+    glBegin(GL_POLYGON);
+    for (int i = 0; i < 360; i++) {
+        float angle = i * 3.14159f / 180.0f;
+        glVertex3f(FIELD_RADIUS * cos(angle), 0.0f, FIELD_RADIUS * sin(angle));
+    }
+    glEnd();
+    PROFILE_DRAW(360);
+
+    glPushMatrix();
+    glLineWidth(10.0);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glRotatef(-90.0f, 0.0f, 1.0f, 0.0f);
+    glBegin(GL_LINES);
+    glVertex3f(0.0f, 0.0f, -5.9f);
+    glVertex3f(0.0f, 0.0f, 5.9f);
+    glEnd();
+    PROFILE_DRAW(2);
+    glPopMatrix();
+
+    glBegin(GL_LINE_STRIP);
+    glLineWidth(10.0);
+    float centerCircleRadius = 1.0f;
+    for (int i = 0; i < 360; i++) {
+        float angle = i * 3.14159f / 180.0f;
+        glVertex3f(centerCircleRadius * cos(angle), 0.0f, centerCircleRadius * sin(angle));
+    }
+    glEnd();
+    PROFILE_DRAW(360);
+}
+
+inline void drawLeftGoal(float x, float z) {
+    glPushMatrix();
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glTranslatef(x, 3.0f, z);
+
+    glPushMatrix();
+    glRotatef(90.0f, 5.0f, 0.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(16.5f, 18.0f, 1.5f);
+    drawHollowPipe(0.1f, 1.5f);
+    glPopMatrix();
+
+    glPushMatrix();
+    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(13.5f, 18.0f, 1.5f);
+    drawHollowPipe(0.1f, 1.5f);
+    glPopMatrix();
+
+    glPushMatrix();
+    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(-18.0f, -1.5f, 13.5f);
+    drawHollowPipe(0.1f, 3.0f);
+    glPopMatrix();
+
+    glPopMatrix();
+    glPopMatrix();
+    glPopMatrix();
+    glPopMatrix();
+}
+
+inline void drawRightGoal(float x, float z) {
+    glPushMatrix();
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glTranslatef(x, 3.0f, z);
+
+    glPushMatrix();
+    glRotatef(90.0f, 5.0f, 0.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(16.5f, 18.0f, 1.5f);
+    drawHollowPipe(0.1f, 1.5f);
+    glPopMatrix();
+
+    glPushMatrix();
+    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(13.5f, 18.0f, 1.5f);
+    drawHollowPipe(0.1f, 1.5f);
+    glPopMatrix();
+
+    glPushMatrix();
+    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(-18.0f, -1.5f, 13.5f);
+    drawHollowPipe(0.1f, 3.0f);
+    glPopMatrix();
+
+    glPopMatrix();
+    glPopMatrix();
+    glPopMatrix();
+    glPopMatrix();
+}
+
+// Goal of the Rocket League stadium: the same layout as drawLeftGoal(), with its own post
+// offsets (18.5 / 12.5) and lengths (2.5 posts, 6.0 crossbar). Both goals in
+// "Rocket League Code.txt" draw the same geometry. The original leaves three matrices pushed;
+// this one restores the stack.
+inline void drawRocketLeagueGoal(float x, float z) {
+    glPushMatrix();
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glTranslatef(x, 3.0f, z);
+
+    glPushMatrix();
+    glRotatef(90.0f, 5.0f, 0.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(18.5f, 18.0f, 0.5f);
+    drawHollowPipe(0.1f, 2.5f);
+    glPopMatrix();
+
+    glPushMatrix();
+    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(12.5f, 18.0f, 0.5f);
+    drawHollowPipe(0.1f, 2.5f);
+    glPopMatrix();
+
+    glPushMatrix();
+    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+
+    glPushMatrix();
+    glTranslatef(-18.0f, -0.6f, 12.5f);
+    drawHollowPipe(0.1f, 6.0f);
+    glPopMatrix();
+
+    glPopMatrix();
+    glPopMatrix();
+    glPopMatrix();
+    glPopMatrix();
+}
+
+inline void batchWheel(MeshBatch& batch, BatchTransform t, float x, float y, float z) {
+    batchTranslate(t, x, y, z);
+    batchRotate(t, 90, 0, 1, 0);
+    batchScale(t, 0.4f, 0.4f, 0.4f);
+    batchAdd(batch, MESH_TORUS, t, 0.1f, 0.1f, 0.1f);
+}
+
+// Queues every part of a car into the batch. The car is drawn by batchDraw(), once per view, and
+// stays queued until the frame's batchClear().
+inline void batchCar(MeshBatch& batch, const Car& car, bool isRed) {
+    BatchTransform base = batchIdentity();
+    batchTranslate(base, car.x, 0.0f, car.z);
+    batchRotate(base, car.rotation, 0.0f, 1.0f, 0.0f);
+
+    // Main body
+    BatchTransform t = base;
+    batchScale(t, 4.0f, 1.5f, 2.0f);
+    if (isRed) {
+        batchAdd(batch, MESH_CUBE, t, 1.0f, 0.0f, 0.0f);
+    } else {
+        batchAdd(batch, MESH_CUBE, t, 0.0f, 0.0f, 1.0f);
+    }
+
+    // Roof
+    t = base;
+    batchTranslate(t, 0.0f, 0.75f, 0.0f);
+    batchScale(t, 2.4f, 0.75f, 2.0f);
+    if (isRed) {
+        batchAdd(batch, MESH_CUBE, t, 0.8f, 0.0f, 0.0f);
+    } else {
+        batchAdd(batch, MESH_CUBE, t, 0.0f, 0.0f, 0.8f);
+    }
+
+    // Windows
+    t = base;
+    batchTranslate(t, 0.0f, 0.45f, 0.0f);
+    batchScale(t, 2.0f, 0.45f, 2.1f);
+    batchAdd(batch, MESH_CUBE, t, 0.1f, 0.1f, 0.1f);
+
+    // Wheels
+    batchWheel(batch, base, 1.4f, -0.75f, 1.1f);
+    batchWheel(batch, base, 1.4f, -0.75f, -1.1f);
+    batchWheel(batch, base, -1.4f, -0.75f, 1.1f);
+    batchWheel(batch, base, -1.4f, -0.75f, -1.1f);
+
+    // Headlights
+    t = base;
+    batchTranslate(t, 1.8f, 0.0f, 0.6f);
+    batchScale(t, 0.2f, 0.2f, 0.2f);
+    batchAdd(batch, MESH_SPHERE, t, 1.0f, 1.0f, 0.0f);
+    t = base;
+    batchTranslate(t, 1.8f, 0.0f, -0.6f);
+    batchScale(t, 0.2f, 0.2f, 0.2f);
+    batchAdd(batch, MESH_SPHERE, t, 1.0f, 1.0f, 0.0f);
+}
+
+// Car of the Rocket League scene (renderBlueCar / renderRedCar): a smaller body with a gray roof,
+// a hood, thin wheels and headlights. The original draws the hood blue on both cars.
+inline void batchRocketLeagueCar(MeshBatch& batch, const Car& car, bool isRed) {
+    BatchTransform base = batchIdentity();
+    batchTranslate(base, car.x, 0.0f, car.z);
+    batchRotate(base, car.rotation, 0.0f, 1.0f, 0.0f);
+
+    // Main body
+    BatchTransform t = base;
+    batchScale(t, 2.0f, 0.5f, 1.0f);
+    if (isRed) {
+        batchAdd(batch, MESH_CUBE, t, 1.0f, 0.0f, 0.0f);
+    } else {
+        batchAdd(batch, MESH_CUBE, t, 0.0f, 0.0f, 1.0f);
+    }
+
+    // Roof
+    t = base;
+    batchTranslate(t, 0.0f, 0.4f, 0.0f);
+    batchScale(t, 1.2f, 0.4f, 0.8f);
+    batchAdd(batch, MESH_CUBE, t, 0.5f, 0.5f, 0.5f);
+
+    // Front hood
+    t = base;
+    batchTranslate(t, 0.7f, 0.1f, 0.0f);
+    batchScale(t, 0.6f, 0.2f, 0.8f);
+    batchAdd(batch, MESH_CUBE, t, 0.0f, 0.0f, 1.0f);
+
+    // Wheels, glutSolidTorus(0.05, 0.15, 10, 10)
+    BatchTransform wheels = base;
+    batchRotate(wheels, 90.0f, 0.0f, 1.0f, 0.0f);
+    for (int i = -1; i <= 1; i += 2) {
+        for (int side = -1; side <= 1; side += 2) {
+            t = wheels;
+            batchTranslate(t, i * 0.9f, -0.3f, side * 0.5f);
+            batchRotate(t, 90.0f, 0.0f, 1.0f, 0.0f);
+            batchScale(t, 0.15f, 0.15f, 0.15f);
+            batchAdd(batch, MESH_THIN_TORUS, t, 0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    // Headlights
+    for (int i = -1; i <= 1; i += 2) {
+        t = base;
+        batchTranslate(t, 1.1f, 0.0f, i * 0.35f);
+        batchScale(t, 0.1f, 0.1f, 0.1f);
+        batchAdd(batch, MESH_SPHERE, t, 1.0f, 1.0f, 0.0f);
+    }
+}
+
+inline void drawFootball(float x, float y, float z) {
+    glPushMatrix();
+    glTranslatef(x, y, z);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    solidSphere(BALL_RADIUS, 20, 10);
+    glPopMatrix();
+}
+
+// The Rocket League ball (drawBall) is twice the size of the Two-cars one
+const float ROCKET_LEAGUE_BALL_RADIUS = 0.5f;
+
+inline void drawRocketLeagueBall(float x, float y, float z) {
+    glPushMatrix();
+    glTranslatef(x, y, z);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    solidSphere(ROCKET_LEAGUE_BALL_RADIUS, 20, 10);
+    glPopMatrix();
+}
+
+// Soft round sprite used for every cloud puff
+inline GLuint skyPuffTexture() {
+    static GLuint texture = 0;
+    if (texture == 0) {
+        const int size = 64;
+        static unsigned char pixels[size * size * 2];
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                float dx = (x + 0.5f) / size * 2.0f - 1.0f;
+                float dy = (y + 0.5f) / size * 2.0f - 1.0f;
+                float a = 1.0f - sqrtf(dx * dx + dy * dy);
+                if (a < 0.0f) a = 0.0f;
+                a = a * (2.0f - a);   // Flatter centre, soft edge
+                pixels[(y * size + x) * 2] = 255;
+                pixels[(y * size + x) * 2 + 1] = (unsigned char)(a * 255.0f);
+            }
+        }
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, size, size, 0,
+                     GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, pixels);
+    }
+    return texture;
+}
+
+// Draws every cloud puff as a camera-facing sprite, sorted back to front, in a single call.
+// Expects the modelview matrix to hold only the camera transform, and the blending, texturing
+// and depth-write state of MATERIAL_SPRITE (render_queue.h).
+inline void drawSky(Sky& sky) {
+    int puffCount = sky.cloudCount * PUFFS_PER_CLOUD;
+    if (puffCount == 0) return;
+
+    // Camera right/up axes and eye position from the view matrix
+    float m[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, m);
+    float rightX = m[0], rightY = m[4], rightZ = m[8];
+    float upX = m[1], upY = m[5], upZ = m[9];
+    float eyeX = -(m[0] * m[12] + m[1] * m[13] + m[2] * m[14]);
+    float eyeY = -(m[4] * m[12] + m[5] * m[13] + m[6] * m[14]);
+    float eyeZ = -(m[8] * m[12] + m[9] * m[13] + m[10] * m[14]);
+
+    sortSkyPuffs(sky, eyeX, eyeY, eyeZ);
+
+    static const float cornerU[4] = {0.0f, 1.0f, 1.0f, 0.0f};
+    static const float cornerV[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    float* v = sky.vertices.data();
+    for (int i = 0; i < puffCount; i++) {
+        int puff = sky.order[i];
+        int cloud = puff / PUFFS_PER_CLOUD;
+        float cx = sky.x[cloud] + sky.offsetX[puff];
+        float cy = sky.y[cloud] + sky.offsetY[puff];
+        float cz = sky.z[cloud] + sky.offsetZ[puff];
+        float r = sky.size[puff];
+
+        for (int c = 0; c < 4; c++) {
+            float sx = (cornerU[c] * 2.0f - 1.0f) * r;
+            float sy = (cornerV[c] * 2.0f - 1.0f) * r;
+            *v++ = cx + rightX * sx + upX * sy;
+            *v++ = cy + rightY * sx + upY * sy;
+            *v++ = cz + rightZ * sx + upZ * sy;
+            *v++ = cornerU[c];
+            *v++ = cornerV[c];
+        }
+    }
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glBindTexture(GL_TEXTURE_2D, skyPuffTexture());
+    glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 5 * sizeof(float), sky.vertices.data());
+    glTexCoordPointer(2, GL_FLOAT, 5 * sizeof(float), sky.vertices.data() + 3);
+    glDrawArrays(GL_QUADS, 0, puffCount * 4);
+    PROFILE_DRAW(puffCount * 4);
+
+    glPopClientAttrib();
+}
+
+// Draw Seats..
+inline void drawCube(float x, float y, float z, float width, float height, float depth) {
+    glPushMatrix();
+    glTranslatef(x, y, z);
+    glScalef(width, height, depth);
+
+    glBegin(GL_QUADS);
+
+    // Front face
+    glColor3f(0.0, 0.0, 0.0);
+    glVertex3f(-0.5, -0.5, 0.5);
+    glVertex3f(0.5, -0.5, 0.5);
+    glVertex3f(0.5, 0.5, 0.5);
+    glVertex3f(-0.5, 0.5, 0.5);
+
+    // Back face
+    glColor3f(0.0, 0.0, 0.0);
+    glVertex3f(-0.5, -0.5, -0.5);
+    glVertex3f(-0.5, 0.5, -0.5);
+    glVertex3f(0.5, 0.5, -0.5);
+    glVertex3f(0.5, -0.5, -0.5);
+
+    // Other faces...
+    glEnd();
+    PROFILE_DRAW(8);
+    glPopMatrix();
+}
+
+// Seats of the Two-cars stadium, one stepped tier per row
+inline void drawSeats(int tiers) {
+    for (int i = 0; i < tiers; i++) {
+        drawCube(-10.0f - i, 0.25f * (i + 1), 0.0f, 1.0f, 0.5f * (i + 1), 15.0f);
+    }
+}
+
+//Draw Circular Football Pitch (Rocket League stadium)
+inline void DrawFootballPitch(float x, float z, double radius, int a) {
+    glPushMatrix();
+    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
+    glBegin(GL_POLYGON);
+    glColor3f(0.0f, 1.0f, 0.0f);
+    for (int i = 0; i <= a; i++) {
+        double angle = i * 3.14 / 180;
+        glVertex2f(radius * cos(angle) + x, radius * sin(angle) + z);
+    }
+    glEnd();
+    PROFILE_DRAW(a + 1);
+
+    glPushMatrix();
+    glLineWidth(10.0);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
+    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+    glBegin(GL_LINES);
+    glVertex3f(0.0f, 0.0f, -15.0f);
+    glVertex3f(0.0f, 0.0f, 25.0f);
+    glEnd();
+    PROFILE_DRAW(2);
+    glPopMatrix();
+
+    glPopMatrix();
+}
+
+//Draw Mid Center Circle..
+inline void MidCircle(float x, float z, double radius, int a) {
+    glPushMatrix();
+    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
+    glBegin(GL_LINE_STRIP);
+    glLineWidth(10.0);
+    glColor3f(1.0, 1.0, 1.0);
+    for (int i = 0; i <= a; i++) {
+        double angle = i * 3.14 / 180;
+        glVertex2f(radius * cos(angle) + x, radius * sin(angle) + z);
+    }
+    glEnd();
+    PROFILE_DRAW(a + 1);
+    glPopMatrix();
+}
+
+// One side of the Rocket League stands (11 tiers in the original scene)
+inline void drawStand(int tiers) {
+    for (int i = 0; i < tiers; i++) {
+        drawCube(-20.0f - i, 0.25f * (i + 1), 0.0f, 1.0f, 0.5f * (i + 1), 35.0f);
+    }
+}
+
+// The four stands around the Rocket League pitch
+inline void drawStadium(int tiers) {
+    glPushMatrix();
+    drawStand(tiers);
+
+    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
+    glTranslatef(-10.f, 0.0f, 0.0f);
+    drawStand(tiers);
+
+    glRotatef(-90.0f, 0.0f, 1.0f, 0.0f);
+    glTranslatef(-10.f, 0.0f, -5.0f);
+    drawStand(tiers);
+
+    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
+    glTranslatef(-15.0f, 0.0f, 0.0f);
+    drawStand(tiers);
+    glPopMatrix();
+}
+
+#endif
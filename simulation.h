@@ -0,0 +1,112 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <math.h>
+#include "sky.h"
+
+// Game state shared by the Two-cars game and the benchmarks. Nothing in here touches GL.
+
+// Constants for field and goal dimensions
+const float FIELD_RADIUS = 6.0f;  // Radius of the circular field
+const float GOAL_WIDTH = 1.5f;    // Width of the goal
+const float GOAL_HEIGHT = 1.0f;
+const float GOAL_DEPTH = 0.1f;    // Depth of the goal
+const float GOAL_OFFSET = 0.5f;   // Distance from the edge of the field to the goalposts
+
+// Car dimensions
+const float CAR_LENGTH = 4.0f;
+const float CAR_WIDTH = 2.0f;
+const float CAR_HEIGHT = 1.5f;
+
+// Car movement properties
+struct Car {
+    float x;
+    float z;
+    float rotation;
+    float speed;
+    float acceleration;
+    bool isAccelerating;
+    bool isBraking;
+    bool isTurningLeft;
+    bool isTurningRight;
+
+    // Set by the contact solver: knock-back velocity and spin left over from collisions
+    float pushX, pushZ;
+    float spin;
+};
+
+// Ball on the pitch; it only moves when something hits it
+const float BALL_RADIUS = 0.25f;    // Same as drawFootball()
+
+struct Football {
+    float x, z;
+    float vx, vz;
+};
+
+const float MAX_SPEED = 0.3f;
+const float ACCELERATION = 0.01f;
+const float BRAKE_FORCE = 0.02f;
+const float TURN_SPEED = 3.0f;
+const float FRICTION = 0.005f;
+
+// Applies the driver's controls to speed and heading, without moving the car
+inline void updateCarControls(Car& car) {
+    // Update acceleration
+    if (car.isAccelerating) {
+        car.acceleration = ACCELERATION;
+    } else if (car.isBraking) {
+        car.acceleration = -BRAKE_FORCE;
+    } else {
+        car.acceleration = 0.0f;
+    }
+
+    // Apply acceleration to speed
+    car.speed += car.acceleration;
+
+    // Apply friction
+    if (car.speed > 0) {
+        car.speed -= FRICTION;
+    } else if (car.speed < 0) {
+        car.speed += FRICTION;
+    }
+
+    // If speed is very close to 0, set it to 0
+    if (fabs(car.speed) < FRICTION) {
+        car.speed = 0.0f;
+    }
+
+    // Clamp speed
+    if (car.speed > MAX_SPEED) car.speed = MAX_SPEED;
+    if (car.speed < -MAX_SPEED/2) car.speed = -MAX_SPEED/2;
+
+    // Update rotation
+    if (car.speed != 0) {
+        if (car.isTurningLeft) car.rotation += TURN_SPEED * (car.speed/MAX_SPEED);
+        if (car.isTurningRight) car.rotation -= TURN_SPEED * (car.speed/MAX_SPEED);
+    }
+}
+
+// Drives the car and keeps it on the field with a hard clamp. stepContacts() in
+// contact_solver.h replaces the movement and the clamp with real collisions.
+inline void updateCarPhysics(Car& car) {
+    updateCarControls(car);
+
+    // Convert rotation to radians for movement calculation
+    float rotationRad = car.rotation * M_PI / 180.0f;
+
+    // Update position based on speed and rotation
+    car.x += car.speed * sin(rotationRad);
+    car.z += car.speed * cos(rotationRad);
+
+    // Keep cars within field bounds
+    float maxDist = FIELD_RADIUS - 2.0f; // Buffer for car size
+    float dist = sqrt(car.x * car.x + car.z * car.z);
+    if (dist > maxDist) {
+        float angle = atan2(car.x, car.z);
+        car.x = maxDist * sin(angle);
+        car.z = maxDist * cos(angle);
+        car.speed *= 0.5f; // Reduce speed on collision
+    }
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef SKY_H
+#define SKY_H
+
+// Cloud layer stored as contiguous arrays.
+//
+// Each cloud is a few puffs whose offsets and sizes are chosen once, from a seeded generator,
+// when the sky is created. The clouds keep their shape from frame to frame, and the render
+// path never calls rand(). drawSky() in scene.h draws every puff as a billboard in one call.
+
+#include <algorithm>
+#include <vector>
+
+const int PUFFS_PER_CLOUD = 3;
+const float SKY_EXTENT = 10.0f;      // Clouds wrap around at +-SKY_EXTENT on X and Z
+const int SKY_LANES = 4;             // Per-cloud arrays are padded to a multiple of this
+
+struct Sky {
+    int cloudCount = 0;
+
+    // Per cloud, padded to a multiple of SKY_LANES with still clouds that are never drawn
+    std::vector<float> x, y, z;
+    std::vector<float> speedX, speedZ;
+
+    // Per puff, PUFFS_PER_CLOUD consecutive entries per cloud
+    std::vector<float> offsetX, offsetY, offsetZ;
+    std::vector<float> size;
+
+    // Back-to-front puff order and the squared eye distance it was sorted by
+    std::vector<int> order;
+    std::vector<float> depth;
+
+    // Billboard vertices rebuilt each frame (x, y, z, u, v per corner)
+    std::vector<float> vertices;
+};
+
+// Small xorshift generator so the sky layout only depends on the seed. Stands in for rand().
+inline int skyNext(unsigned int& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (int)(state >> 8);
+}
+
+// Same values as the old initClouds()/drawCloud(), but each puff is placed once
+inline void initSky(Sky& sky, int cloudCount, unsigned int seed) {
+    unsigned int state = seed ? seed : 1;
+    int puffCount = cloudCount * PUFFS_PER_CLOUD;
+    int paddedCount = (cloudCount + SKY_LANES - 1) / SKY_LANES * SKY_LANES;
+
+    sky.cloudCount = cloudCount;
+    sky.x.assign(paddedCount, 0.0f);
+    sky.y.assign(paddedCount, 0.0f);
+    sky.z.assign(paddedCount, 0.0f);
+    sky.speedX.assign(paddedCount, 0.0f);
+    sky.speedZ.assign(paddedCount, 0.0f);
+    sky.offsetX.resize(puffCount);
+    sky.offsetY.resize(puffCount);
+    sky.offsetZ.resize(puffCount);
+    sky.size.resize(puffCount);
+    sky.order.resize(puffCount);
+    sky.depth.resize(puffCount);
+    sky.vertices.resize(puffCount * 4 * 5);
+
+    for (int i = 0; i < cloudCount; i++) {
+        sky.x[i] = skyNext(state) % 20 - 10;
+        sky.y[i] = 5 + skyNext(state) % 5;
+        sky.z[i] = skyNext(state) % 20 - 10;
+        sky.speedX[i] = (skyNext(state) % 3 + 1) * 0.002f;
+        sky.speedZ[i] = (skyNext(state) % 3 + 1) * 0.002f;
+        float cloudSize = skyNext(state) % 3 + 2;
+
+        for (int j = 0; j < PUFFS_PER_CLOUD; j++) {
+            int puff = i * PUFFS_PER_CLOUD + j;
+            sky.offsetX[puff] = (skyNext(state) % 200 - 100) / 100.0f;
+            sky.offsetY[puff] = (skyNext(state) % 200 - 100) / 100.0f;
+            sky.offsetZ[puff] = (skyNext(state) % 200 - 100) / 100.0f;
+            sky.size[puff] = cloudSize * ((skyNext(state) % 50 + 50) / 100.0f);
+        }
+    }
+    for (int i = 0; i < puffCount; i++) sky.order[i] = i;
+}
+
+// Moves count clouds by their speed, wrapping around the sky area. count must be a multiple
+// of SKY_LANES. Straight-line selects over arrays that cannot overlap, with no remainder loop,
+// so GCC 12 vectorises it at -O2 (-fopt-info-vec reports 16-byte vectors).
+inline void moveClouds(float* __restrict x, float* __restrict z, const float* __restrict speedX,
+                       const float* __restrict speedZ, int count) {
+    count &= ~(SKY_LANES - 1);
+    for (int i = 0; i < count; i++) {
+        float nx = x[i] + speedX[i];
+        float nz = z[i] + speedZ[i];
+        nx = nx > SKY_EXTENT ? -SKY_EXTENT : nx;
+        nx = nx < -SKY_EXTENT ? SKY_EXTENT : nx;
+        nz = nz > SKY_EXTENT ? -SKY_EXTENT : nz;
+        nz = nz < -SKY_EXTENT ? SKY_EXTENT : nz;
+        x[i] = nx;
+        z[i] = nz;
+    }
+}
+
+inline void updateSky(Sky& sky) {
+    moveClouds(sky.x.data(), sky.z.data(), sky.speedX.data(), sky.speedZ.data(), (int)sky.x.size());
+}
+
+// Orders the puffs back to front as seen from (eyeX, eyeY, eyeZ), once for all clouds
+inline void sortSkyPuffs(Sky& sky, float eyeX, float eyeY, float eyeZ) {
+    int puffCount = sky.cloudCount * PUFFS_PER_CLOUD;
+    for (int puff = 0; puff < puffCount; puff++) {
+        int cloud = puff / PUFFS_PER_CLOUD;
+        float dx = sky.x[cloud] + sky.offsetX[puff] - eyeX;
+        float dy = sky.y[cloud] + sky.offsetY[puff] - eyeY;
+        float dz = sky.z[cloud] + sky.offsetZ[puff] - eyeZ;
+        sky.depth[puff] = dx * dx + dy * dy + dz * dz;
+    }
+
+    const float* depth = sky.depth.data();
+    std::sort(sky.order.begin(), sky.order.end(), [depth](int a, int b) { return depth[a] > depth[b]; });
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef TICK_ARENA_H
+#define TICK_ARENA_H
+
+// Per-tick linear arena for data that only lives until the end of a tick: AI paths, player
+// lists, outgoing message batches.
+//
+// allocate() bumps an offset into a chunk, and reset() frees everything at once by rewinding
+// it. Chunks are kept across resets, so once the first ticks have sized the arena a tick takes
+// nothing from the general heap. ArenaVector is a std::vector drawing from the arena. Freeing
+// is a no-op, so reserve() up front rather than letting a vector grow.
+//
+// A TickScope marks one tick and resets the arena when it closes. Build with
+// -DTRACK_TICK_ALLOCATIONS and expand TICK_ALLOCATION_TRACKING once, next to main(), to count
+// every general-heap allocation made while a TickScope is open on the calling thread.
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef TRACK_TICK_ALLOCATIONS
+#include <stdlib.h>
+#include <atomic>
+#endif
+
+const size_t TICK_ARENA_CHUNK_SIZE = 64 * 1024;
+
+class TickArena {
+private:
+    struct Chunk {
+        unsigned char* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t current = 0;         // Chunk being allocated from
+    size_t offset = 0;          // Next free byte in it
+    size_t filledBytes = 0;     // Size of the chunks before the current one
+    size_t highWater = 0;
+
+    void addChunk(size_t size) {
+        Chunk chunk = {static_cast<unsigned char*>(::operator new(size)), size};
+        chunks.push_back(chunk);
+    }
+
+public:
+    explicit TickArena(size_t initialSize = TICK_ARENA_CHUNK_SIZE) {
+        addChunk(initialSize);
+    }
+
+    ~TickArena() {
+        for (size_t i = 0; i < chunks.size(); i++) ::operator delete(chunks[i].data);
+    }
+
+    TickArena(const TickArena&) = delete;
+    TickArena& operator=(const TickArena&) = delete;
+
+    // alignment must be a power of two no larger than alignof(max_align_t)
+    void* allocate(size_t size, size_t alignment) {
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+        while (start + size > chunks[current].size) {
+            // Move on to the next chunk, adding one big enough if there is none
+            filledBytes += chunks[current].size;
+            current++;
+            if (current == chunks.size()) {
+                addChunk(size > TICK_ARENA_CHUNK_SIZE ? size : TICK_ARENA_CHUNK_SIZE);
+            }
+            start = 0;
+        }
+        offset = start + size;
+        return chunks[current].data + start;
+    }
+
+    // Frees everything allocated since the last reset
+    void reset() {
+        size_t used = bytesUsed();
+        if (used > highWater) highWater = used;
+        current = 0;
+        offset = 0;
+        filledBytes = 0;
+    }
+
+    size_t bytesUsed() const { return filledBytes + offset; }
+    size_t highWaterBytes() const { return highWater; }
+    int chunkCount() const { return (int)chunks.size(); }
+};
+
+// Standard allocator over a TickArena; deallocate() does nothing
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+
+    TickArena* arena;
+
+    explicit ArenaAllocator(TickArena& a) : arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Empty vector on the arena with room for capacity elements
+template <typename T>
+ArenaVector<T> arenaVector(TickArena& arena, size_t capacity) {
+    ArenaVector<T> v((ArenaAllocator<T>(arena)));
+    v.reserve(capacity);
+    return v;
+}
+
+// Constructs a T on the arena. Its destructor never runs, so T must keep all of its own
+// storage on the arena too (e.g. an ArenaVector).
+template <typename T, typename... Args>
+T* arenaCreate(TickArena& arena, Args&&... args) {
+    return new (arena.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+
+#ifdef TRACK_TICK_ALLOCATIONS
+// General-heap allocations made inside a TickScope, on any thread
+inline std::atomic<long long>& tickHeapAllocations() {
+    static std::atomic<long long> count{0};
+    return count;
+}
+
+inline int& tickScopeDepth() {
+    static thread_local int depth = 0;
+    return depth;
+}
+
+// Replacement global operator new/delete; expand in exactly one file
+#define TICK_ALLOCATION_TRACKING                                           \
+    void* operator new(size_t size) {                                      \
+        if (tickScopeDepth() > 0) {                                        \
+            tickHeapAllocations().fetch_add(1, std::memory_order_relaxed); \
+        }                                                                  \
+        void* p = malloc(size ? size : 1);                                 \
+        if (!p) throw std::bad_alloc();                                    \
+        return p;                                                          \
+    }                                                                      \
+    void operator delete(void* p) noexcept { free(p); }                    \
+    void operator delete(void* p, size_t) noexcept { free(p); }
+#else
+#define TICK_ALLOCATION_TRACKING
+#endif
+
+// Marks one tick on the calling thread and resets the arena when it closes
+class TickScope {
+private:
+    TickArena& arena;
+
+public:
+    explicit TickScope(TickArena& a) : arena(a) {
+#ifdef TRACK_TICK_ALLOCATIONS
+        tickScopeDepth()++;
+#endif
+    }
+
+    ~TickScope() {
+        arena.reset();
+#ifdef TRACK_TICK_ALLOCATIONS
+        tickScopeDepth()--;
+#endif
+    }
+
+    TickScope(const TickScope&) = delete;
+    TickScope& operator=(const TickScope&) = delete;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+// Lock-free triple buffer for handing snapshots from one writer thread to one reader thread.
+//
+// The writer fills writeBuffer() and calls publish(). The reader calls latest() and gets the
+// newest published snapshot. Writer and reader each own one of the three slots, and the third
+// slot is swapped between them with a single atomic exchange, so neither side ever waits and
+// neither sees a half-written snapshot. If the writer publishes several times between two
+// reads, the older snapshots are simply overwritten.
+
+#include <atomic>
+
+template <typename T>
+class TripleBuffer {
+private:
+    static const int FRESH = 4;         // Set on the shared slot when it holds an unread snapshot
+
+    T buffers[3];
+    std::atomic<int> shared{2};         // Slot index in transit, plus FRESH
+    int writeIndex = 0;                 // Owned by the writer
+    int readIndex = 1;                  // Owned by the reader
+
+public:
+    // Lets the caller set up all three slots the same way before the threads start
+    T& slot(int index) { return buffers[index]; }
+
+    // Writer: the slot to fill for the next publish()
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    // Writer: makes the filled slot available to the reader
+    void publish() {
+        writeIndex = shared.exchange(writeIndex | FRESH, std::memory_order_acq_rel) & 3;
+    }
+
+    // Reader: true if a snapshot was published since the last latest()
+    bool hasUpdate() const {
+        return (shared.load(std::memory_order_acquire) & FRESH) != 0;
+    }
+
+    // Reader: the newest snapshot. It stays valid, and private to the reader, until the next call.
+    T& latest() {
+        if (hasUpdate()) {
+            readIndex = shared.exchange(readIndex, std::memory_order_acq_rel) & 3;
+        }
+        return buffers[readIndex];
+    }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+// Persistent worker threads for splitting one tick's work into independent tasks.
+//
+// The threads are started once and sleep on a condition variable between jobs, so running a
+// job costs a wake-up rather than a thread start. parallelFor() also works on the calling
+// thread and returns once every task has finished. Tasks are a plain function pointer and
+// context, so submitting a job never allocates.
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One worker per spare hardware thread, at most 7
+inline int defaultWorkerCount() {
+    int threads = (int)std::thread::hardware_concurrency() - 1;
+    if (threads < 0) return 0;
+    return threads > 7 ? 7 : threads;
+}
+
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Current job, written under the mutex before the workers are woken
+    void (*task)(void* context, int index) = nullptr;
+    void* context = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask{0};
+    int busyWorkers = 0;
+    unsigned int generation = 0;
+    bool stopping = false;
+
+    void runTasks() {
+        int index;
+        while ((index = nextTask.fetch_add(1, std::memory_order_relaxed)) < taskCount) {
+            task(context, index);
+        }
+    }
+
+    void workerLoop() {
+        unsigned int seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+
+            lock.unlock();
+            runTasks();
+            lock.lock();
+            if (--busyWorkers == 0) done.notify_one();
+        }
+    }
+
+public:
+    // threadCount extra threads; 0 runs everything on the calling thread
+    explicit WorkerPool(int threadCount) {
+        for (int i = 0; i < threadCount; i++) {
+            threads.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int threadCount() const { return (int)threads.size(); }
+
+    // Calls fn(ctx, i) for every i in [0, count) and waits for all of them
+    void parallelFor(int count, void (*fn)(void*, int), void* ctx) {
+        if (threads.empty() || count <= 1) {
+            for (int i = 0; i < count; i++) fn(ctx, i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = fn;
+            context = ctx;
+            taskCount = count;
+            nextTask.store(0, std::memory_order_relaxed);
+            busyWorkers = (int)threads.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        runTasks();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return busyWorkers == 0; });
+    }
+};
+
+#endif